@@ -39,8 +39,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "okfft.h"
 
 #include <stdio.h>  // for printf (default log)
-#include <stdlib.h> // for qsort
+#include <stdlib.h> // for malloc / free (default allocators)
 #include <string.h> // for memset
+#include <math.h>   // for cos / sin (mixed radix twiddles)
+#include <mutex>    // for the shared twiddles
+
+#ifdef __linux__
+    #include <sys/mman.h> // for madvise (huge page plan arenas)
+#endif
 
 #ifdef _MSC_VER
     #include <intrin.h>
@@ -52,7 +58,75 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     #define OKFFT_ALIGN(x) __attribute__((aligned(x)))
 #endif
 
-// predefined xform prototypes (implementations are found in okfft_xf_sse.cpp, and okfft_xf_avx.cpp)
+// predefined xform prototypes (implementations are found in okfft_xf_sse.cpp, okfft_xf_avx.cpp, okfft_xf_fma.cpp and okfft_xf_avx512.cpp)
+#ifdef OKFFT_HAS_AVX512
+
+void okfft_avx512_fwd_32(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_fwd_64(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_fwd_128(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_fwd_256(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_fwd_512(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_fwd_1024(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_fwd_2048(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_fwd_4096(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_fwd_8192(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_fwd_generic(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_fwd_passes(const okfft_plan_t *plan, float *__restrict data, size_t N);
+void okfft_avx512_fwd_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end);
+
+void okfft_avx512_fwd_real(float *__restrict output, float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N);
+
+void okfft_avx512_inv_32(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_inv_64(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_inv_128(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_inv_256(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_inv_512(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_inv_1024(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_inv_2048(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_inv_4096(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_inv_8192(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_inv_generic(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx512_inv_passes(const okfft_plan_t *plan, float *__restrict data, size_t N);
+void okfft_avx512_inv_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end);
+
+void okfft_avx512_inv_real(float *__restrict output, const float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N);
+
+#endif
+
+#ifdef OKFFT_HAS_FMA
+
+void okfft_fma_fwd_32(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_fwd_64(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_fwd_128(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_fwd_256(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_fwd_512(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_fwd_1024(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_fwd_2048(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_fwd_4096(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_fwd_8192(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_fwd_generic(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_fwd_passes(const okfft_plan_t *plan, float *__restrict data, size_t N);
+void okfft_fma_fwd_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end);
+
+void okfft_fma_fwd_real(float *__restrict output, float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N);
+
+void okfft_fma_inv_32(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_inv_64(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_inv_128(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_inv_256(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_inv_512(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_inv_1024(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_inv_2048(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_inv_4096(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_inv_8192(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_inv_generic(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_fma_inv_passes(const okfft_plan_t *plan, float *__restrict data, size_t N);
+void okfft_fma_inv_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end);
+
+void okfft_fma_inv_real(float *__restrict output, const float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N);
+
+#endif
+
 #ifdef OKFFT_HAS_AVX
 
 void okfft_avx_fwd_32(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
@@ -65,6 +139,8 @@ void okfft_avx_fwd_2048(const okfft_plan_t *plan, float *__restrict output, cons
 void okfft_avx_fwd_4096(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
 void okfft_avx_fwd_8192(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
 void okfft_avx_fwd_generic(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx_fwd_passes(const okfft_plan_t *plan, float *__restrict data, size_t N);
+void okfft_avx_fwd_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end);
 
 void okfft_avx_fwd_real(float *__restrict output, float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N);
 
@@ -78,6 +154,8 @@ void okfft_avx_inv_2048(const okfft_plan_t *plan, float *__restrict output, cons
 void okfft_avx_inv_4096(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
 void okfft_avx_inv_8192(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
 void okfft_avx_inv_generic(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_avx_inv_passes(const okfft_plan_t *plan, float *__restrict data, size_t N);
+void okfft_avx_inv_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end);
 
 void okfft_avx_inv_real(float *__restrict output, const float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N);
 
@@ -95,104 +173,1185 @@ void okfft_sse_fwd_2048(const okfft_plan_t *plan, float *__restrict output, cons
 void okfft_sse_fwd_4096(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
 void okfft_sse_fwd_8192(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
 void okfft_sse_fwd_generic(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_sse_fwd_passes(const okfft_plan_t *plan, float *__restrict data, size_t N);
+void okfft_sse_fwd_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end);
+
+void okfft_sse_fwd_real(float *__restrict output, float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N);
+
+void okfft_sse_inv_32(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_sse_inv_64(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_sse_inv_128(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_sse_inv_256(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_sse_inv_512(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_sse_inv_1024(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_sse_inv_2048(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_sse_inv_4096(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_sse_inv_8192(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_sse_inv_generic(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_sse_inv_passes(const okfft_plan_t *plan, float *__restrict data, size_t N);
+void okfft_sse_inv_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end);
+
+void okfft_sse_inv_real(float *__restrict output, const float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N);
+
+#endif
+
+#ifdef OKFFT_HAS_AVX
+
+void okfft_avx_d_fwd(const okfft_plan_d_t *plan, double *__restrict output, const double *__restrict input);
+void okfft_avx_d_inv(const okfft_plan_d_t *plan, double *__restrict output, const double *__restrict input);
+
+#endif
+
+// double precision xforms (okfft_xf_sse_d.cpp and okfft_xf_avx_d.cpp), the real passes and small xforms are shared by all sets
+void okfft_sse_d_fwd(const okfft_plan_d_t *plan, double *__restrict output, const double *__restrict input);
+void okfft_sse_d_inv(const okfft_plan_d_t *plan, double *__restrict output, const double *__restrict input);
+
+void okfft_sse_d_fwd_real(double *__restrict output, double *__restrict buffer, const double *__restrict A, const double *__restrict B, size_t N);
+void okfft_sse_d_inv_real(double *__restrict output, const double *__restrict buffer, const double *__restrict A, const double *__restrict B, size_t N);
+
+void okfft_small_d_2(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in);
+void okfft_small_d_fwd_4(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in);
+void okfft_small_d_inv_4(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in);
+void okfft_small_d_fwd_8(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in);
+void okfft_small_d_inv_8(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in);
+void okfft_small_d_fwd_16(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in);
+void okfft_small_d_inv_16(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in);
+
+void okfft_small_2(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
+void okfft_small_fwd_4(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
+void okfft_small_inv_4(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
+void okfft_small_fwd_8(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
+void okfft_small_inv_8(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
+void okfft_small_fwd_16(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
+void okfft_small_inv_16(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
+
+void okfft_small_real_fwd_4(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in);
+void okfft_small_real_fwd_8(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in);
+void okfft_small_real_fwd_16(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in);
+void okfft_small_real_fwd_32(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in);
+void okfft_small_real_inv_4(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in);
+void okfft_small_real_inv_8(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in);
+void okfft_small_real_inv_16(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in);
+void okfft_small_real_inv_32(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in);
+
+// mixed radix and bluestein xforms (okfft_xf_mixed.cpp), shared by all sets
+void okfft_mixed_fwd(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_mixed_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_bluestein(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+
+// non contiguous layouts (okfft_xf_layout.cpp), shared by all sets
+void okfft_layout_strided_fwd(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_layout_strided_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_layout_split_fwd(const okfft_plan_t *plan, float *__restrict out_re, float *__restrict out_im, const float *__restrict in_re, const float *__restrict in_im);
+void okfft_layout_split_inv(const okfft_plan_t *plan, float *__restrict out_re, float *__restrict out_im, const float *__restrict in_re, const float *__restrict in_im);
+void okfft_layout_inplace_fwd(const okfft_plan_t *plan, float *output, const float *input);
+void okfft_layout_inplace_inv(const okfft_plan_t *plan, float *output, const float *input);
+void okfft_layout_2d(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_layout_3d(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_layout_real_2d_fwd(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_layout_real_2d_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_layout_fourstep(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_layout_bidir_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+
+// xforms split across the worker threads (okfft_threads.cpp), shared by all sets
+void okfft_parallel_fwd(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+void okfft_parallel_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+
+// tables of imported wisdom files, mapped read only (okfft_wisdom.cpp)
+const uint32_t *okfft_wisdom_offsets(size_t N);
+const float *okfft_wisdom_twiddles(size_t N, bool is_inverse, size_t layout, const ptrdiff_t **ws_is, size_t *table_N);
+bool okfft_wisdom_contains(const void *p);
+
+#define OKFFT_FLAG_INVERSE_XFORM    1
+#define OKFFT_FLAG_AVX              2
+#define OKFFT_FLAG_SMALL            4
+#define OKFFT_FLAG_FMA              8
+#define OKFFT_FLAG_AVX512          16
+#define OKFFT_FLAG_SMALL_REAL      32
+
+static uint32_t *okfft_init_offsets(size_t N);
+static void okfft_init_indices(ptrdiff_t *is, size_t N);
+static void okfft_init_twiddles(okfft_plan_t *p, size_t N, bool is_inverse);
+static void okfft_retain_twiddles(okfft_twiddles_t *t);
+static void okfft_release_twiddles(okfft_twiddles_t *t);
+static void okfft_init_twiddles_d(okfft_plan_d_t *p, size_t N, bool is_inverse);
+size_t okfft_twiddles_size(size_t N, size_t *lut_count);
+static void okfft_init_real_coeffs(okfft_plan_t *p, size_t N, bool is_inverse);
+static void okfft_init_real_coeffs_d(okfft_plan_d_t *p, size_t N, bool is_inverse);
+static void okfft_init_small_real_coeffs(okfft_plan_t *p, size_t N, bool is_inverse);
+static void okfft_init_mixed_twiddles(okfft_plan_t *p, size_t N, bool is_inverse);
+static size_t okfft_mixed_twiddles_count(const okfft_plan_t *p);
+static void okfft_init_chirp(okfft_plan_t *p, size_t N, bool is_inverse);
+static void okfft_init_inplace_cycles(okfft_plan_t *p, size_t N);
+static void okfft_init_fourstep_twiddles(okfft_plan_t *p, size_t N, bool is_inverse);
+static inline size_t okfft_ilog2(size_t N);
+static okfft_plan_t *okfft_pack_plan(okfft_plan_t *p);
+static okfft_plan_d_t *okfft_pack_plan_d(okfft_plan_d_t *p);
+static void okfft_free_plan(okfft_plan_t *p, bool release_twiddles, const char *lo, const char *hi);
+static void okfft_free_plan_d(okfft_plan_d_t *p);
+
+static const size_t leaf_N = 8;
+
+// the leaf offsets are 32 bit indices of floats
+static const size_t max_N = (size_t) 1 << 31;
+
+// smaller parallel plans run on the calling thread only, the work is likely too small to hand out (an estimate, the
+// scaling hasn't been measured)
+static const size_t parallel_N = 128 * 1024;
+
+// smaller four step plans are regular plans, below this the recursive passes run in L2
+static const size_t fourstep_N = 256 * 1024;
+
+// smallest shared twiddle table (48 KB), smaller plans use a prefix of it
+static const size_t twiddles_min_N = 4096;
+
+// plan arenas from this size are 2 MB aligned and rounded up to huge pages
+static const size_t arena_huge_size = 2 * 1024 * 1024;
+
+// smaller in place xforms copy the input to scratch, it's faster and the copy is small (1 MB at this size)
+static const size_t inplace_permute_N = 128 * 1024;
+
+// ISA DISPATCH
+
+typedef void (*okfft_real_fwd_func_t)(float *__restrict output, float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N);
+typedef void (*okfft_real_inv_func_t)(float *__restrict output, const float *__restrict input, const float *__restrict A, const float *__restrict B, size_t N);
+
+// 32, 64, ..., 8192 and the generic xform
+#define OKFFT_KERNEL_SIZES 10
+
+struct okfft_kernels_t
+{
+    OKFFT_ISA isa;
+    const char *name;
+    size_t flags;                       // twiddle / coeff layout the kernels expect
+
+    okfft_xform_func_t fwd[OKFFT_KERNEL_SIZES];
+    okfft_xform_func_t inv[OKFFT_KERNEL_SIZES];
+
+    okfft_passes_func_t fwd_passes;     // combine passes for any N >= 32
+    okfft_passes_func_t inv_passes;
+    okfft_x8_func_t fwd_x8;             // one slice of the last (radix 8) combine pass of N >= 32
+    okfft_x8_func_t inv_x8;
+
+    okfft_real_fwd_func_t fwd_real;
+    okfft_real_inv_func_t inv_real;
+
+    // double precision, any size >= 32 (the tables always use the sse layout)
+    okfft_xform_d_func_t fwd_d;
+    okfft_xform_d_func_t inv_d;
+};
+
+#define OKFFT_KERNEL_SET(isa, name, flags, prefix, prefix_d)                        \
+{                                                                                   \
+    isa, name, flags,                                                               \
+    {                                                                               \
+        prefix##_fwd_32,   prefix##_fwd_64,   prefix##_fwd_128,  prefix##_fwd_256,  \
+        prefix##_fwd_512,  prefix##_fwd_1024, prefix##_fwd_2048, prefix##_fwd_4096, \
+        prefix##_fwd_8192, prefix##_fwd_generic                                     \
+    },                                                                              \
+    {                                                                               \
+        prefix##_inv_32,   prefix##_inv_64,   prefix##_inv_128,  prefix##_inv_256,  \
+        prefix##_inv_512,  prefix##_inv_1024, prefix##_inv_2048, prefix##_inv_4096, \
+        prefix##_inv_8192, prefix##_inv_generic                                     \
+    },                                                                              \
+    prefix##_fwd_passes, prefix##_inv_passes,                                       \
+    prefix##_fwd_x8, prefix##_inv_x8,                                               \
+    prefix##_fwd_real, prefix##_inv_real,                                           \
+    prefix_d##_fwd, prefix_d##_inv                                                  \
+}
+
+#ifdef OKFFT_HAS_SSE
+static const okfft_kernels_t okfft_sse_kernels = OKFFT_KERNEL_SET(OKFFT_ISA_SSE, "sse", 0, okfft_sse, okfft_sse_d);
+#endif
+
+#ifdef OKFFT_HAS_AVX
+static const okfft_kernels_t okfft_avx_kernels = OKFFT_KERNEL_SET(OKFFT_ISA_AVX, "avx", OKFFT_FLAG_AVX, okfft_avx, okfft_avx_d);
+#endif
+
+#ifdef OKFFT_HAS_FMA
+static const okfft_kernels_t okfft_fma_kernels = OKFFT_KERNEL_SET(OKFFT_ISA_FMA, "fma", OKFFT_FLAG_AVX | OKFFT_FLAG_FMA, okfft_fma, okfft_avx_d);
+#endif
+
+#ifdef OKFFT_HAS_AVX512
+static const okfft_kernels_t okfft_avx512_kernels = OKFFT_KERNEL_SET(OKFFT_ISA_AVX512, "avx512", OKFFT_FLAG_AVX | OKFFT_FLAG_FMA | OKFFT_FLAG_AVX512, okfft_avx512, okfft_avx_d);
+#endif
+
+#undef OKFFT_KERNEL_SET
+
+static void okfft_cpuid(int leaf, int data[4])
+{
+    #ifdef _MSC_VER
+        __cpuidex(data, leaf, 0);
+    #else
+        __asm__ __volatile__ ("cpuid" :
+            "=a" (data[0]), "=b" (data[1]), "=c" (data[2]), "=d" (data[3]) : "a" (leaf), "c" (0));
+    #endif
+}
+
+static unsigned long long okfft_xgetbv()
+{
+    #ifdef _MSC_VER
+        return _xgetbv(0);
+    #else
+        unsigned int lo, hi;
+        __asm__ __volatile__ ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+        return ((unsigned long long) hi << 32) | lo;
+    #endif
+}
+
+// highest isa the cpu *and* the OS support, ymm / zmm state has to be saved by the OS on context switches
+static OKFFT_ISA okfft_cpu_max_isa()
+{
+    int data[4];
+    okfft_cpuid(0, data);
+    const int max_leaf = data[0];
+
+    okfft_cpuid(1, data);
+    const bool has_sse2    = (data[3] & (1 << 26)) != 0;
+    const bool has_fma     = (data[2] & (1 << 12)) != 0;
+    const bool has_osxsave = (data[2] & (1 << 27)) != 0;
+    const bool has_avx     = (data[2] & (1 << 28)) != 0;
+
+    if (!has_sse2)
+        return OKFFT_ISA_AUTO;
+
+    if (!has_osxsave || !has_avx)
+        return OKFFT_ISA_SSE;
+
+    // xmm and ymm state
+    const unsigned long long xcr0 = okfft_xgetbv();
+    if ((xcr0 & 0x6) != 0x6)
+        return OKFFT_ISA_SSE;
+
+    if (!has_fma)
+        return OKFFT_ISA_AVX;
+
+    // opmask, zmm0-15 upper halves and zmm16-31 state
+    if (max_leaf >= 7 && (xcr0 & 0xe0) == 0xe0)
+    {
+        okfft_cpuid(7, data);
+        if (data[1] & (1 << 16))
+            return OKFFT_ISA_AVX512;
+    }
+
+    return OKFFT_ISA_FMA;
+}
+
+// returns NULL if the set isn't compiled in
+static const okfft_kernels_t *okfft_kernels_for(OKFFT_ISA isa)
+{
+    switch (isa)
+    {
+    #ifdef OKFFT_HAS_SSE
+        case OKFFT_ISA_SSE:    return &okfft_sse_kernels;
+    #endif
+    #ifdef OKFFT_HAS_AVX
+        case OKFFT_ISA_AVX:    return &okfft_avx_kernels;
+    #endif
+    #ifdef OKFFT_HAS_FMA
+        case OKFFT_ISA_FMA:    return &okfft_fma_kernels;
+    #endif
+    #ifdef OKFFT_HAS_AVX512
+        case OKFFT_ISA_AVX512: return &okfft_avx512_kernels;
+    #endif
+        default:               return NULL;
+    }
+}
+
+// best compiled in set the cpu can run, or NULL
+static const okfft_kernels_t *okfft_best_kernels(OKFFT_ISA max_isa)
+{
+    for (int isa = (int) max_isa; isa > (int) OKFFT_ISA_AUTO; isa--)
+    {
+        if (const okfft_kernels_t *k = okfft_kernels_for((OKFFT_ISA) isa))
+            return k;
+    }
+
+    return NULL;
+}
+
+static OKFFT_ISA okfft_parse_isa(const char *name)
+{
+    static const char *const names[] = { "auto", "sse", "avx", "fma", "avx512" };
+
+    for (int isa = 0; isa < (int) (sizeof(names) / sizeof(names[0])); isa++)
+    {
+        if (strcmp(name, names[isa]) == 0)
+            return (OKFFT_ISA) isa;
+    }
+
+    OKFFT_LOG("Unknown OKFFT_ISA '%s' (expected auto, sse, avx, fma or avx512), using auto.\n", name);
+    return OKFFT_ISA_AUTO;
+}
+
+static const okfft_kernels_t *okfft_select_kernels(OKFFT_ISA max_isa, OKFFT_ISA isa)
+{
+    if (isa == OKFFT_ISA_AUTO)
+        return okfft_best_kernels(max_isa);
+
+    const okfft_kernels_t *k = okfft_kernels_for(isa);
+    if (!k)
+    {
+        OKFFT_LOG("Requested isa was not compiled in.\n");
+        return NULL;
+    }
+
+    if (isa > max_isa)
+    {
+        OKFFT_LOG("Requested isa '%s' is not supported by this cpu / OS.\n", k->name);
+        return NULL;
+    }
+
+    return k;
+}
+
+static const okfft_kernels_t *okfft_resolve_kernels()
+{
+    const OKFFT_ISA max_isa = okfft_cpu_max_isa();
+    const okfft_kernels_t *k = NULL;
+
+    if (const char *env = getenv("OKFFT_ISA"))
+        k = okfft_select_kernels(max_isa, okfft_parse_isa(env));
+
+    return k ? k : okfft_best_kernels(max_isa);
+}
+
+// resolved once at load, plans keep a pointer to the set they were created with
+static const okfft_kernels_t *okfft_active_kernels = okfft_resolve_kernels();
+
+bool okfft_set_isa(OKFFT_ISA isa)
+{
+    const okfft_kernels_t *k = okfft_select_kernels(okfft_cpu_max_isa(), isa);
+    if (!k)
+        return false;
+
+    okfft_active_kernels = k;
+    return true;
+}
+
+OKFFT_ISA okfft_get_isa()
+{
+    if (!okfft_active_kernels)
+        okfft_active_kernels = okfft_resolve_kernels();
+
+    return okfft_active_kernels ? okfft_active_kernels->isa : OKFFT_ISA_AUTO;
+}
+
+// validates the arguments and returns the kernel set for a new plan, NULL on error
+static const okfft_kernels_t *okfft_plan_kernels(size_t N, OKFFT_DIRECTION dir)
+{
+    _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    
+    if (!(dir == OKFFT_DIR_FORWARD || dir == OKFFT_DIR_INVERSE))
+    {
+        OKFFT_LOG("Invalid direction for FFT (expected 'OKFFT_DIR_FORWARD' or 'OKFFT_DIR_INVERSE').");
+        return NULL;
+    }
+
+    if (N < 2)
+    {
+        OKFFT_LOG("Minimum FFT size is 2, size %zu provided.", N);
+        return NULL;
+    }
+
+    if (N > max_N)
+    {
+        OKFFT_LOG("Maximum FFT size is 2^31, size %zu provided.", N);
+        return NULL;
+    }
+
+    // plans may be created from static initializers running before ours
+    if (!okfft_active_kernels)
+        okfft_active_kernels = okfft_resolve_kernels();
+
+    const okfft_kernels_t *kernels = okfft_active_kernels;
+    if (!kernels)
+        OKFFT_LOG("Cpu does not support any of the kernel sets OKFFT was built with.");
+
+    return kernels;
+}
+
+static bool okfft_check_pow2(size_t N)
+{
+    if ((N & (N - 1)))
+    {
+        OKFFT_LOG("FFT size must be a power of two. Size %zu provided.", N);
+        return false;
+    }
+
+    return true;
+}
+
+// number of EE and OO / EE2 leaf iterations
+static void okfft_init_leaf_counts(size_t N, size_t *i0, size_t *i1)
+{
+    size_t imm = N / leaf_N / 3;
+    *i0 = imm + 1;
+    *i1 = imm;
+
+    if (((N / leaf_N) % 3) > 1)
+        (*i1)++;
+
+    *i0 /= 2;
+    *i1 /= 2;
+}
+
+static okfft_plan_t *okfft_new_plan(size_t N, OKFFT_DIRECTION dir);
+static okfft_plan_t *okfft_new_plan_real(size_t N, OKFFT_DIRECTION dir);
+
+// N = P * M, P = 2^a and M = 3^b * 5^c
+static okfft_plan_t *okfft_create_plan_mixed(size_t N, size_t M, OKFFT_DIRECTION dir, const okfft_kernels_t *kernels)
+{
+    const size_t P = N / M;
+
+    okfft_plan_t *sub = NULL;
+    if (P > 1)
+    {
+        sub = okfft_new_plan(P, dir);
+        if (!sub)
+            return NULL;
+    }
+
+    okfft_plan_t *plan = (okfft_plan_t *) OKFFT_ALLOC_PLAN(sizeof(*plan));
+    memset(plan, 0, sizeof(*plan));
+
+    plan->N = N;
+    plan->M = M;
+    plan->sub = sub;
+    plan->kernels = kernels;
+
+    for (size_t m = M; m % 5 == 0; m /= 5)
+        plan->radix[plan->radix_count++] = 5;
+
+    for (size_t m = M; m % 3 == 0; m /= 3)
+        plan->radix[plan->radix_count++] = 3;
+
+    if (dir == OKFFT_DIR_INVERSE)
+        plan->flags |= OKFFT_FLAG_INVERSE_XFORM;
+
+    okfft_init_mixed_twiddles(plan, N, dir == OKFFT_DIR_INVERSE);
+
+    plan->xform = dir == OKFFT_DIR_FORWARD ? okfft_mixed_fwd : okfft_mixed_inv;
+    return plan;
+}
+
+// any N, convolution with a power of two xform of L >= 2N - 1 points
+static okfft_plan_t *okfft_create_plan_bluestein(size_t N, OKFFT_DIRECTION dir, const okfft_kernels_t *kernels)
+{
+    size_t L = 4;
+    while (L < 2 * N - 1)
+        L *= 2;
+
+    okfft_plan_t *sub = okfft_new_plan(L, OKFFT_DIR_FORWARD);
+    if (!sub)
+        return NULL;
+
+    okfft_plan_t *plan = (okfft_plan_t *) OKFFT_ALLOC_PLAN(sizeof(*plan));
+    memset(plan, 0, sizeof(*plan));
+
+    plan->N = N;
+    plan->sub = sub;
+    plan->kernels = kernels;
+
+    if (dir == OKFFT_DIR_INVERSE)
+        plan->flags |= OKFFT_FLAG_INVERSE_XFORM;
+
+    okfft_init_chirp(plan, N, dir == OKFFT_DIR_INVERSE);
+
+    plan->xform = okfft_bluestein;
+    return plan;
+}
+
+// a plan under construction, its tables and sub plans are separate blocks until 'okfft_pack_plan' moves them into one
+static okfft_plan_t *okfft_new_plan(size_t N, OKFFT_DIRECTION dir)
+{
+    const okfft_kernels_t *kernels = okfft_plan_kernels(N, dir);
+    if (!kernels)
+        return NULL;
+
+    size_t M = 1;
+    while ((N / M) % 5 == 0) M *= 5;
+    while ((N / M) % 3 == 0) M *= 3;
+
+    if (((N / M) & (N / M - 1)))
+        return okfft_create_plan_bluestein(N, dir, kernels);
+
+    if (M > 1)
+        return okfft_create_plan_mixed(N, M, dir, kernels);
+
+    okfft_plan_t *plan = (okfft_plan_t *) OKFFT_ALLOC_PLAN(sizeof(*plan));
+    memset(plan, 0, sizeof(*plan));
+
+    plan->N = N;
+    plan->kernels = kernels;
+
+    okfft_init_leaf_counts(N, &plan->i0, &plan->i1);
+
+    if (dir == OKFFT_DIR_INVERSE)
+        plan->flags |= OKFFT_FLAG_INVERSE_XFORM;
+
+    if (N < 32)
+    {
+        plan->flags |= OKFFT_FLAG_SMALL;
+        if (dir == OKFFT_DIR_FORWARD)
+        {
+            switch (N)
+            {
+            case  2: plan->xform = okfft_small_2;      break;
+            case  4: plan->xform = okfft_small_fwd_4;  break;
+            case  8: plan->xform = okfft_small_fwd_8;  break;
+            case 16: plan->xform = okfft_small_fwd_16; break;
+            }
+        }
+        else
+        {
+            switch (N)
+            {
+            case  2: plan->xform = okfft_small_2;      break;
+            case  4: plan->xform = okfft_small_inv_4;  break;
+            case  8: plan->xform = okfft_small_inv_8;  break;
+            case 16: plan->xform = okfft_small_inv_16; break;
+            }
+        }
+
+        return plan;
+    }
+
+    plan->flags |= kernels->flags;
+
+    plan->offsets = okfft_init_offsets(N);
+    okfft_init_indices(plan->is, N);
+    okfft_init_twiddles(plan, N, dir == OKFFT_DIR_INVERSE);
+
+    const size_t size_index = okfft_ilog2(N) - 5;
+    const size_t index = size_index < OKFFT_KERNEL_SIZES - 1 ? size_index : OKFFT_KERNEL_SIZES - 1;
+
+    if (dir == OKFFT_DIR_FORWARD)
+    {
+        plan->xform = kernels->fwd[index];
+        plan->passes = kernels->fwd_passes;
+        plan->x8 = kernels->fwd_x8;
+    }
+    else
+    {
+        plan->xform = kernels->inv[index];
+        plan->passes = kernels->inv_passes;
+        plan->x8 = kernels->inv_x8;
+    }
+
+    return plan;
+}
+
+okfft_plan_t *okfft_create_plan(size_t N, OKFFT_DIRECTION dir)
+{
+    return okfft_pack_plan(okfft_new_plan(N, dir));
+}
+
+okfft_plan_t *okfft_create_plan_strided(size_t N, OKFFT_DIRECTION dir, size_t istride, size_t ostride)
+{
+    if (istride < 1 || ostride < 1)
+    {
+        OKFFT_LOG("Strides must be at least 1, got %zu and %zu.", istride, ostride);
+        return NULL;
+    }
+
+    okfft_plan_t *plan = okfft_new_plan(N, dir);
+    if (!plan)
+        return NULL;
+
+    plan->istride = istride;
+    plan->ostride = ostride;
+    plan->xform_contig = plan->xform;
+    plan->xform = dir == OKFFT_DIR_FORWARD ? okfft_layout_strided_fwd : okfft_layout_strided_inv;
+
+    return okfft_pack_plan(plan);
+}
+
+okfft_plan_t *okfft_create_plan_split(size_t N, OKFFT_DIRECTION dir)
+{
+    okfft_plan_t *plan = okfft_new_plan(N, dir);
+    if (!plan)
+        return NULL;
+
+    plan->xform_contig = plan->xform;
+    plan->xform_split = dir == OKFFT_DIR_FORWARD ? okfft_layout_split_fwd : okfft_layout_split_inv;
+
+    return okfft_pack_plan(plan);
+}
+
+okfft_plan_t *okfft_create_plan_inplace(size_t N, OKFFT_DIRECTION dir)
+{
+    okfft_plan_t *plan = okfft_new_plan(N, dir);
+    if (!plan)
+        return NULL;
+
+    if (plan->passes && N >= inplace_permute_N)
+        okfft_init_inplace_cycles(plan, N);
+
+    plan->xform_contig = plan->xform;
+    plan->xform = dir == OKFFT_DIR_FORWARD ? okfft_layout_inplace_fwd : okfft_layout_inplace_inv;
+
+    return okfft_pack_plan(plan);
+}
+
+okfft_plan_t *okfft_create_plan_bidir(size_t N)
+{
+    okfft_plan_t *plan = okfft_new_plan(N, OKFFT_DIR_FORWARD);
+    if (!plan)
+        return NULL;
+
+    plan->xform_contig = plan->xform;
+    plan->xform_inv = okfft_layout_bidir_inv;
+
+    return okfft_pack_plan(plan);
+}
+
+okfft_plan_t *okfft_create_plan_parallel(size_t N, OKFFT_DIRECTION dir)
+{
+    okfft_plan_t *plan = okfft_new_plan(N, dir);
+    if (!plan)
+        return NULL;
+
+    if (plan->passes && N >= parallel_N)
+    {
+        plan->xform_contig = plan->xform;
+        plan->xform = dir == OKFFT_DIR_FORWARD ? okfft_parallel_fwd : okfft_parallel_inv;
+    }
+
+    return okfft_pack_plan(plan);
+}
+
+// row major multi dimensional plans, one 1d plan per dimension (a real one for the rows if 'real_rows')
+static okfft_plan_t *okfft_create_plan_nd(size_t rank, const size_t *dims, OKFFT_DIRECTION dir, okfft_xform_func_t xform, bool real_rows)
+{
+    for (size_t i = 0; i < rank; i++)
+    {
+        if (dims[i] < 2)
+        {
+            OKFFT_LOG("Smallest supported size along every dimension is 2, got %zu!\n", dims[i]);
+            return NULL;
+        }
+
+        if (!okfft_check_pow2(dims[i]))
+            return NULL;
+    }
+
+    okfft_plan_t *plan = (okfft_plan_t *) OKFFT_ALLOC_PLAN(sizeof(*plan));
+    memset(plan, 0, sizeof(*plan));
+
+    plan->N = 1;
+    plan->rank = rank;
+
+    for (size_t i = 0; i < rank; i++)
+    {
+        plan->N *= dims[i];
+        plan->dims[i] = dims[i];
+        plan->dim_plans[i] = real_rows && i == rank - 1 ? okfft_new_plan_real(dims[i], dir) : okfft_new_plan(dims[i], dir);
+
+        if (!plan->dim_plans[i])
+        {
+            okfft_destroy_plan(plan);
+            return NULL;
+        }
+    }
+
+    plan->kernels = plan->dim_plans[rank - 1]->kernels;
+    plan->xform = xform;
+
+    if (dir == OKFFT_DIR_INVERSE)
+        plan->flags |= OKFFT_FLAG_INVERSE_XFORM;
+
+    return plan;
+}
+
+okfft_plan_t *okfft_create_plan_2d(size_t rows, size_t cols, OKFFT_DIRECTION dir)
+{
+    const size_t dims[2] = { rows, cols };
+    return okfft_pack_plan(okfft_create_plan_nd(2, dims, dir, okfft_layout_2d, false));
+}
+
+okfft_plan_t *okfft_create_plan_3d(size_t d0, size_t d1, size_t d2, OKFFT_DIRECTION dir)
+{
+    const size_t dims[3] = { d0, d1, d2 };
+    return okfft_pack_plan(okfft_create_plan_nd(3, dims, dir, okfft_layout_3d, false));
+}
+
+okfft_plan_t *okfft_create_plan_real_2d(size_t rows, size_t cols, OKFFT_DIRECTION dir)
+{
+    const size_t dims[2] = { rows, cols };
+    return okfft_pack_plan(okfft_create_plan_nd(2, dims, dir, dir == OKFFT_DIR_FORWARD ? okfft_layout_real_2d_fwd : okfft_layout_real_2d_inv, true));
+}
+
+// the N2 x N1 view of N, a 2d plan with the twiddle multiply in between the column and row xforms
+okfft_plan_t *okfft_create_plan_fourstep(size_t N, OKFFT_DIRECTION dir)
+{
+    if (N < fourstep_N || (N & (N - 1)))
+        return okfft_create_plan(N, dir);
+
+    const size_t N1 = (size_t) 1 << (okfft_ilog2(N) / 2);
+    const size_t dims[2] = { N / N1, N1 };
+
+    okfft_plan_t *plan = okfft_create_plan_nd(2, dims, dir, okfft_layout_fourstep, false);
+    if (!plan)
+        return NULL;
+
+    okfft_init_fourstep_twiddles(plan, N, dir == OKFFT_DIR_INVERSE);
+    return okfft_pack_plan(plan);
+}
+
+static okfft_plan_t *okfft_new_plan_real(size_t N, OKFFT_DIRECTION dir)
+{
+    if (N < 4)
+    {
+        OKFFT_LOG("Smallest supported real transform size is 4, got %zu!\n", N);
+        return NULL;
+    }
+
+    if (!okfft_check_pow2(N))
+        return NULL;
+
+    okfft_plan_t *plan = okfft_new_plan(N / 2, dir);
+
+    if (plan && N < 64)
+    {
+        // unrolled kernels around the small complex ones, no state buffer needed
+        plan->flags |= OKFFT_FLAG_SMALL_REAL;
+        okfft_init_small_real_coeffs(plan, N, dir == OKFFT_DIR_INVERSE);
+
+        if (dir == OKFFT_DIR_FORWARD)
+        {
+            switch (N)
+            {
+            case  4: plan->xform = okfft_small_real_fwd_4;  break;
+            case  8: plan->xform = okfft_small_real_fwd_8;  break;
+            case 16: plan->xform = okfft_small_real_fwd_16; break;
+            case 32: plan->xform = okfft_small_real_fwd_32; break;
+            }
+        }
+        else
+        {
+            switch (N)
+            {
+            case  4: plan->xform = okfft_small_real_inv_4;  break;
+            case  8: plan->xform = okfft_small_real_inv_8;  break;
+            case 16: plan->xform = okfft_small_real_inv_16; break;
+            case 32: plan->xform = okfft_small_real_inv_32; break;
+            }
+        }
+
+        return plan;
+    }
+
+    if (plan)
+        okfft_init_real_coeffs(plan, N, dir == OKFFT_DIR_INVERSE);
+
+    return plan;
+}
+
+okfft_plan_t *okfft_create_plan_real(size_t N, OKFFT_DIRECTION dir)
+{
+    return okfft_pack_plan(okfft_new_plan_real(N, dir));
+}
+
+okfft_buffer_t okfft_create_buffer(size_t N)
+{
+    okfft_buffer_t s = { (float *) OKFFT_ALLOC_BUFFER((N + 2) * sizeof(float)) };
+    return s;
+}
+
+void okfft_destroy_buffer(okfft_buffer_t *s)
+{
+    OKFFT_FREE_BUFFER(s->buffer);
+    s->buffer = NULL;
+}
+
+void okfft_destroy_plan(okfft_plan_t *plan)
+{
+    okfft_free_plan(plan, true, NULL, NULL);
+}
+
+void okfft_execute(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    plan->xform(plan, output, input);
+}
+
+void okfft_execute_dir(const okfft_plan_t *plan, OKFFT_DIRECTION dir, float *__restrict output, const float *__restrict input)
+{
+    if (dir == OKFFT_DIR_INVERSE)
+        plan->xform_inv(plan, output, input);
+    else
+        plan->xform(plan, output, input);
+}
+
+void okfft_execute_split(const okfft_plan_t *plan, float *__restrict out_re, float *__restrict out_im, const float *__restrict in_re, const float *__restrict in_im)
+{
+    plan->xform_split(plan, out_re, out_im, in_re, in_im);
+}
+
+void okfft_execute_real(const okfft_plan_t *plan, okfft_buffer_t *state, float *__restrict output, const float *__restrict input)
+{
+    if (plan->flags & OKFFT_FLAG_SMALL_REAL)
+    {
+        plan->xform(plan, output, input);
+        return;
+    }
+
+    if (plan->flags & OKFFT_FLAG_INVERSE_XFORM)
+    {
+        plan->kernels->inv_real(state->buffer, input, plan->A, plan->B, plan->N << 1);
+        plan->xform(plan, output, state->buffer);
+    }
+    else
+    {
+        plan->xform(plan, state->buffer, input);
+        plan->kernels->fwd_real(output, state->buffer, plan->A, plan->B, plan->N << 1);
+    }
+}
+
+// PLAN ARENA
+
+// A plan is built from separate blocks, then moved into one: the plan, its tables and its sub plans, each 64 byte
+// aligned, in a single allocation (2 MB aligned huge pages for the large ones). The shared twiddles stay outside.
+struct okfft_table_t
+{
+    void **ptr;
+    size_t size;
+    bool aligned;                       // 'OKFFT_ALLOC_ALIGNED_DATA', else 'OKFFT_ALLOC_DATA'
+};
+
+static inline size_t okfft_arena_align(size_t size)
+{
+    return (size + 63) & ~(size_t) 63;
+}
+
+// the tables owned by the plan (not its sub plans), NULL ones included
+static size_t okfft_plan_tables(okfft_plan_t *plan, okfft_table_t *t)
+{
+    const size_t N = plan->N;
+    const bool small_real = (plan->flags & OKFFT_FLAG_SMALL_REAL) != 0;
+    const size_t L = (size_t) 1 << plan->fs_shift;
+
+    t[0] = { (void **) &plan->offsets,   N / leaf_N * sizeof(uint32_t),                  false };
+    t[1] = { (void **) &plan->A,         (small_real ? 8 * N : 2 * N) * sizeof(float),   true  };
+    t[2] = { (void **) &plan->B,         2 * N * sizeof(float),                          true  };
+    t[3] = { (void **) &plan->mr_ws,     8 * okfft_mixed_twiddles_count(plan) * sizeof(float), true };
+    t[4] = { (void **) &plan->mr_dit,    2 * N * sizeof(float),                          true  };
+    t[5] = { (void **) &plan->chirp,     2 * N * sizeof(float),                          true  };
+    t[6] = { (void **) &plan->chirp_ft,  (plan->sub ? 2 * plan->sub->N : 0) * sizeof(float), true };
+    t[7] = { (void **) &plan->ip_cycles, plan->ip_cycles_size * sizeof(uint32_t),        false };
+    t[8] = { (void **) &plan->fs_ws,     2 * (L + N / L) * sizeof(float),                true  };
+    return 9;
+}
+
+static size_t okfft_plan_tables_d(okfft_plan_d_t *plan, okfft_table_t *t)
+{
+    const size_t N = plan->N;
+
+    size_t lut_count = 0, lut_size = 0;
+    if (plan->ws)
+        lut_size = okfft_twiddles_size(N, &lut_count);
+
+    t[0] = { (void **) &plan->ws,      lut_size * sizeof(double),      true  };
+    t[1] = { (void **) &plan->ws_is,   lut_count * sizeof(ptrdiff_t),  true  };
+    t[2] = { (void **) &plan->offsets, N / leaf_N * sizeof(uint32_t),  false };
+    t[3] = { (void **) &plan->A,       2 * N * sizeof(double),         true  };
+    t[4] = { (void **) &plan->B,       2 * N * sizeof(double),         true  };
+    return 5;
+}
+
+static size_t okfft_arena_tables_size(const okfft_table_t *t, size_t count)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++)
+        if (*t[i].ptr && !okfft_wisdom_contains(*t[i].ptr)) size += okfft_arena_align(t[i].size);
+
+    return size;
+}
+
+// moves the tables of a copied plan header to 'cursor', the ones in wisdom files stay where they are
+static char *okfft_arena_copy_tables(const okfft_table_t *t, size_t count, char *cursor)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!*t[i].ptr || okfft_wisdom_contains(*t[i].ptr))
+            continue;
+
+        memcpy(cursor, *t[i].ptr, t[i].size);
+        *t[i].ptr = cursor;
+        cursor += okfft_arena_align(t[i].size);
+    }
+
+    return cursor;
+}
+
+// frees the tables not in the arena [lo, hi)
+static void okfft_free_tables(const okfft_table_t *t, size_t count, const char *lo, const char *hi)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const char *p = (const char *) *t[i].ptr;
+        if (!p || (p >= lo && p < hi) || okfft_wisdom_contains(p))
+            continue;
+
+        if (t[i].aligned)
+            OKFFT_FREE_ALIGNED_DATA(*t[i].ptr);
+        else
+            OKFFT_FREE_DATA(*t[i].ptr);
+    }
+}
+
+static size_t okfft_arena_size(const okfft_plan_t *plan)
+{
+    okfft_plan_t tmp = *plan;
+    okfft_table_t t[9];
+
+    size_t size = okfft_arena_align(sizeof(*plan)) + okfft_arena_tables_size(t, okfft_plan_tables(&tmp, t));
+
+    if (plan->sub)
+        size += okfft_arena_size(plan->sub);
+
+    for (size_t i = 0; i < plan->rank; i++)
+        size += okfft_arena_size(plan->dim_plans[i]);
+
+    return size;
+}
+
+// copies the plan to 'cursor' (advanced past it), one more reference on the twiddles if 'retain'
+static okfft_plan_t *okfft_arena_copy(const okfft_plan_t *plan, char **cursor, bool retain)
+{
+    okfft_plan_t *copy = (okfft_plan_t *) *cursor;
+    memcpy(copy, plan, sizeof(*plan));
+    copy->arena = NULL;
+    copy->arena_size = 0;
+
+    okfft_table_t t[9];
+    *cursor = okfft_arena_copy_tables(t, okfft_plan_tables(copy, t), *cursor + okfft_arena_align(sizeof(*plan)));
+
+    if (plan->sub)
+        copy->sub = okfft_arena_copy(plan->sub, cursor, retain);
+
+    for (size_t i = 0; i < plan->rank; i++)
+        copy->dim_plans[i] = okfft_arena_copy(plan->dim_plans[i], cursor, retain);
+
+    if (retain && plan->twiddles)
+        okfft_retain_twiddles(plan->twiddles);
+
+    return copy;
+}
+
+static void *okfft_alloc_arena(size_t *size)
+{
+    if (*size < arena_huge_size)
+        return OKFFT_ALLOC_PLAN_ARENA(*size, 64);
+
+    *size = (*size + arena_huge_size - 1) & ~(arena_huge_size - 1);
+    void *arena = OKFFT_ALLOC_PLAN_ARENA(*size, arena_huge_size);
+
+#ifdef MADV_HUGEPAGE
+    if (arena)
+        madvise(arena, *size, MADV_HUGEPAGE);
+#endif
+
+    return arena;
+}
+
+// the plan in a new arena, NULL if out of memory
+static okfft_plan_t *okfft_arena_plan(const okfft_plan_t *plan, bool retain)
+{
+    size_t size = okfft_arena_size(plan);
+    void *arena = okfft_alloc_arena(&size);
+    if (!arena)
+        return NULL;
+
+    char *cursor = (char *) arena;
+    okfft_plan_t *copy = okfft_arena_copy(plan, &cursor, retain);
+    copy->arena = arena;
+    copy->arena_size = size;
+    return copy;
+}
+
+// frees the plan, its sub plans and the tables not in the arena [lo, hi) of the plan owning them
+static void okfft_free_plan(okfft_plan_t *plan, bool release_twiddles, const char *lo, const char *hi)
+{
+    if (!plan)
+        return;
+
+    if (plan->arena)
+    {
+        lo = (const char *) plan->arena;
+        hi = lo + plan->arena_size;
+    }
+
+    okfft_table_t t[9];
+    okfft_free_tables(t, okfft_plan_tables(plan, t), lo, hi);
+
+    okfft_free_plan(plan->sub, release_twiddles, lo, hi);
+
+    for (size_t i = 0; i < plan->rank; i++)
+        okfft_free_plan(plan->dim_plans[i], release_twiddles, lo, hi);
+
+    if (release_twiddles && plan->twiddles)
+        okfft_release_twiddles(plan->twiddles);
+
+    if (plan->arena)
+        OKFFT_FREE_PLAN_ARENA(plan->arena);
+    else if ((const char *) plan < lo || (const char *) plan >= hi)
+        OKFFT_FREE_PLAN(plan);
+}
+
+// moves a plan under construction into an arena, the plan is left as it is if that fails
+static okfft_plan_t *okfft_pack_plan(okfft_plan_t *plan)
+{
+    if (!plan)
+        return NULL;
+
+    okfft_plan_t *packed = okfft_arena_plan(plan, false);
+    if (!packed)
+        return plan;
+
+    okfft_free_plan(plan, false, NULL, NULL);
+    return packed;
+}
 
-void okfft_sse_fwd_real(float *__restrict output, float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N);
+okfft_plan_t *okfft_copy_plan(const okfft_plan_t *plan)
+{
+    okfft_plan_t *copy = okfft_arena_plan(plan, true);
+    if (copy)
+        copy->cache = NULL;
 
-void okfft_sse_inv_32(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
-void okfft_sse_inv_64(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
-void okfft_sse_inv_128(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
-void okfft_sse_inv_256(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
-void okfft_sse_inv_512(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
-void okfft_sse_inv_1024(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
-void okfft_sse_inv_2048(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
-void okfft_sse_inv_4096(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
-void okfft_sse_inv_8192(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
-void okfft_sse_inv_generic(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+    return copy;
+}
 
-void okfft_sse_inv_real(float *__restrict output, const float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N);
+static okfft_plan_d_t *okfft_pack_plan_d(okfft_plan_d_t *plan)
+{
+    if (!plan)
+        return NULL;
 
-#endif
+    okfft_table_t t[5];
+    size_t size = okfft_arena_align(sizeof(*plan)) + okfft_arena_tables_size(t, okfft_plan_tables_d(plan, t));
 
-void okfft_small_2(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
-void okfft_small_fwd_4(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
-void okfft_small_inv_4(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
-void okfft_small_fwd_8(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
-void okfft_small_inv_8(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
-void okfft_small_fwd_16(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
-void okfft_small_inv_16(const okfft_plan_t *, float *__restrict out, const float *__restrict in);
+    void *arena = okfft_alloc_arena(&size);
+    if (!arena)
+        return plan;
 
-#define OKFFT_FLAG_INVERSE_XFORM    1
-#define OKFFT_FLAG_AVX              2
-#define OKFFT_FLAG_SMALL            4
+    okfft_plan_d_t *packed = (okfft_plan_d_t *) arena;
+    memcpy(packed, plan, sizeof(*plan));
+    packed->arena = arena;
+    packed->arena_size = size;
 
-static void okfft_init_offsets(okfft_plan_t *p, size_t N);
-static void okfft_init_indices(okfft_plan_t *p, size_t N);
-static void okfft_init_twiddles(okfft_plan_t *p, size_t N, bool is_inverse);
-static void okfft_init_real_coeffs(okfft_plan_t *p, size_t N, bool is_inverse);
+    okfft_arena_copy_tables(t, okfft_plan_tables_d(packed, t), (char *) arena + okfft_arena_align(sizeof(*plan)));
 
-static const size_t leaf_N = 8;
+    okfft_free_plan_d(plan);
+    return packed;
+}
 
-#ifdef OKFFT_HAS_AVX
-static bool okfft_cpu_has_avx()
+static void okfft_free_plan_d(okfft_plan_d_t *plan)
 {
-    int data[4];
-    #ifdef _MSC_VER
-        __cpuid(data, 1);    
-    #else
-        #define __cpuid(func,ax,bx,cx,dx)\
-	        __asm__ __volatile__ ("cpuid":\
-	            "=a" (ax), "=b" (bx), "=c" (cx), "=d" (dx) : "a" (func));
-        __cpuid(1, data[0], data[1], data[2], data[3]);
-    #endif
-    return (data[2] & (1 << 28)) != 0;
+    if (!plan)
+        return;
+
+    const char *lo = (const char *) plan->arena;
+    const char *hi = lo + plan->arena_size;
+
+    okfft_table_t t[5];
+    okfft_free_tables(t, okfft_plan_tables_d(plan, t), lo, hi);
+
+    if (plan->arena)
+        OKFFT_FREE_PLAN_ARENA(plan->arena);
+    else
+        OKFFT_FREE_PLAN(plan);
 }
-#endif
 
-okfft_plan_t *okfft_create_plan(size_t N, OKFFT_DIRECTION dir)
+// SCRATCH
+
+// grow only, one set per thread so plans stay thread safe for execute
+struct okfft_scratch_t
 {
-    _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
-    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-    
-    if (!(dir == OKFFT_DIR_FORWARD || dir == OKFFT_DIR_INVERSE))
+    float *data[OKFFT_SCRATCH_SLOTS];
+    size_t size[OKFFT_SCRATCH_SLOTS];
+
+    ~okfft_scratch_t()
     {
-        OKFFT_LOG("Invalid direction for FFT (expected 'OKFFT_DIR_FORWARD' or 'OKFFT_DIR_INVERSE').");
-        return NULL;
+        for (size_t i = 0; i < OKFFT_SCRATCH_SLOTS; i++)
+            if (data[i]) OKFFT_FREE_BUFFER(data[i]);
     }
+};
 
-    if (N < 2)
+static thread_local okfft_scratch_t okfft_scratch;
+
+// 'size' floats, kept until the thread exits
+float *okfft_thread_scratch(size_t slot, size_t size)
+{
+    okfft_scratch_t &s = okfft_scratch;
+    if (s.size[slot] < size)
     {
-        OKFFT_LOG("Minimum FFT size is 2, size %zu provided.", N);
-        return NULL;
+        if (s.data[slot])
+            OKFFT_FREE_BUFFER(s.data[slot]);
+
+        s.data[slot] = (float *) OKFFT_ALLOC_BUFFER(size * sizeof(float));
+        s.size[slot] = size;
     }
 
-    if ((N & (N - 1)))
+    return s.data[slot];
+}
+
+// BATCHED EXECUTION
+
+// pulls the next transform's input towards L2 while the current one runs,
+// skipped for inputs that would push the current working set out (the hardware prefetcher does fine on those)
+static inline void okfft_prefetch_input(const float *input, size_t count)
+{
+    if (count * sizeof(float) > 128 * 1024)
+        return;
+
+    for (size_t i = 0; i < count; i += 64 / sizeof(float))
+        _mm_prefetch((const char *) (input + i), _MM_HINT_T1);
+}
+
+void okfft_execute_batch(const okfft_plan_t *plan, size_t howmany, const float *input, ptrdiff_t idist, float *output, ptrdiff_t odist)
+{
+    const okfft_xform_func_t xform = plan->xform;
+    const size_t count = 2 * plan->N;
+
+    for (size_t i = 0; i < howmany; i++, input += idist, output += odist)
     {
-        OKFFT_LOG("FFT size must be a power of two. Size %zu provided.", N);
-        return NULL;
+        if (i + 1 < howmany)
+            okfft_prefetch_input(input + idist, count);
+
+        xform(plan, output, input);
     }
+}
+
+void okfft_execute_real_batch(const okfft_plan_t *plan, okfft_buffer_t *state, size_t howmany, const float *input, ptrdiff_t idist, float *output, ptrdiff_t odist)
+{
+    // N real values in, N / 2 + 1 complex values out (and the other way around for the inverse)
+    const size_t count = (plan->flags & OKFFT_FLAG_INVERSE_XFORM) ? 2 * plan->N + 2 : 2 * plan->N;
 
-    #if defined(OKFFT_HAS_AVX) && !defined(OKFFT_HAS_SSE)
-    if (!okfft_cpu_has_avx())
+    for (size_t i = 0; i < howmany; i++, input += idist, output += odist)
     {
-        OKFFT_LOG("Cpu does not support AVX, but OKFFT was built without SSE support.");
-        return NULL;
+        if (i + 1 < howmany)
+            okfft_prefetch_input(input + idist, count);
+
+        okfft_execute_real(plan, state, output, input);
     }
-    #endif
+}
 
-    okfft_plan_t *plan = (okfft_plan_t *) OKFFT_ALLOC_PLAN(sizeof(*plan));
-    memset(plan, 0, sizeof(*plan));
+// DOUBLE PRECISION
 
-    plan->N = N;
+static okfft_plan_d_t *okfft_new_plan_d(size_t N, OKFFT_DIRECTION dir)
+{
+    const okfft_kernels_t *kernels = okfft_plan_kernels(N, dir);
+    if (!kernels || !okfft_check_pow2(N))
+        return NULL;
 
-    size_t imm = N / leaf_N / 3;
-    plan->i0 = imm + 1;
-    plan->i1 = imm;
+    okfft_plan_d_t *plan = (okfft_plan_d_t *) OKFFT_ALLOC_PLAN(sizeof(*plan));
+    memset(plan, 0, sizeof(*plan));
 
-    if (((N / leaf_N) % 3) > 1)
-        plan->i1++;
+    plan->N = N;
+    plan->kernels = kernels;
 
-    plan->i0 /= 2;
-    plan->i1 /= 2;
+    okfft_init_leaf_counts(N, &plan->i0, &plan->i1);
 
     if (dir == OKFFT_DIR_INVERSE)
         plan->flags |= OKFFT_FLAG_INVERSE_XFORM;
@@ -204,292 +1363,210 @@ okfft_plan_t *okfft_create_plan(size_t N, OKFFT_DIRECTION dir)
         {
             switch (N)
             {
-            case  2: plan->xform = okfft_small_2;
-            case  4: plan->xform = okfft_small_fwd_4;
-            case  8: plan->xform = okfft_small_fwd_8;
-            case 16: plan->xform = okfft_small_fwd_16;
+            case  2: plan->xform = okfft_small_d_2;      break;
+            case  4: plan->xform = okfft_small_d_fwd_4;  break;
+            case  8: plan->xform = okfft_small_d_fwd_8;  break;
+            case 16: plan->xform = okfft_small_d_fwd_16; break;
             }
         }
         else
         {
             switch (N)
             {
-            case  2: plan->xform = okfft_small_2;
-            case  4: plan->xform = okfft_small_inv_4;
-            case  8: plan->xform = okfft_small_inv_8;
-            case 16: plan->xform = okfft_small_inv_16;
+            case  2: plan->xform = okfft_small_d_2;      break;
+            case  4: plan->xform = okfft_small_d_inv_4;  break;
+            case  8: plan->xform = okfft_small_d_inv_8;  break;
+            case 16: plan->xform = okfft_small_d_inv_16; break;
             }
         }
 
         return plan;
     }
 
-    #ifdef OKFFT_HAS_AVX
-    if (okfft_cpu_has_avx())
-        plan->flags |= OKFFT_FLAG_AVX;
-    #endif
-
-    okfft_init_offsets(plan, N);
-    okfft_init_indices(plan, N);
-    okfft_init_twiddles(plan, N, dir == OKFFT_DIR_INVERSE);
-
-    if (dir == OKFFT_DIR_FORWARD)
-    {
-        #ifdef OKFFT_HAS_AVX
-        if (okfft_cpu_has_avx())
-        {
-            switch (N)
-            {
-                case   32: plan->xform = okfft_avx_fwd_32;      break;
-                case   64: plan->xform = okfft_avx_fwd_64;      break;
-                case  128: plan->xform = okfft_avx_fwd_128;     break;
-                case  256: plan->xform = okfft_avx_fwd_256;     break;
-                case  512: plan->xform = okfft_avx_fwd_512;     break;
-                case 1024: plan->xform = okfft_avx_fwd_1024;    break;
-                case 2048: plan->xform = okfft_avx_fwd_2048;    break;
-                case 4096: plan->xform = okfft_avx_fwd_4096;    break;
-                case 8192: plan->xform = okfft_avx_fwd_8192;    break;
-                default:   plan->xform = okfft_avx_fwd_generic; break;
-            }
-        }
-        else
-        #endif
-        {
-        #ifdef OKFFT_HAS_SSE
-            switch (N)
-            {
-                case   32: plan->xform = okfft_sse_fwd_32;      break;
-                case   64: plan->xform = okfft_sse_fwd_64;      break;
-                case  128: plan->xform = okfft_sse_fwd_128;     break;
-                case  256: plan->xform = okfft_sse_fwd_256;     break;
-                case  512: plan->xform = okfft_sse_fwd_512;     break;
-                case 1024: plan->xform = okfft_sse_fwd_1024;    break;
-                case 2048: plan->xform = okfft_sse_fwd_2048;    break;
-                case 4096: plan->xform = okfft_sse_fwd_4096;    break;
-                case 8192: plan->xform = okfft_sse_fwd_8192;    break;
-                default:   plan->xform = okfft_sse_fwd_generic; break;
-            }
-        #endif
-        }
-
-    }
-    else
-    {
-        #ifdef OKFFT_HAS_AVX
-        if (okfft_cpu_has_avx())
-        {
-            switch (N)
-            {
-                case   32: plan->xform = okfft_avx_inv_32;      break;
-                case   64: plan->xform = okfft_avx_inv_64;      break;
-                case  128: plan->xform = okfft_avx_inv_128;     break;
-                case  256: plan->xform = okfft_avx_inv_256;     break;
-                case  512: plan->xform = okfft_avx_inv_512;     break;
-                case 1024: plan->xform = okfft_avx_inv_1024;    break;
-                case 2048: plan->xform = okfft_avx_inv_2048;    break;
-                case 4096: plan->xform = okfft_avx_inv_4096;    break;
-                case 8192: plan->xform = okfft_avx_inv_8192;    break;
-                default:   plan->xform = okfft_avx_inv_generic; break;
-            }
-        }
-        else
-        #endif
-        {
-            #ifdef OKFFT_HAS_SSE
-            switch (N)
-            {
-                case   32: plan->xform = okfft_sse_inv_32;      break;
-                case   64: plan->xform = okfft_sse_inv_64;      break;
-                case  128: plan->xform = okfft_sse_inv_128;     break;
-                case  256: plan->xform = okfft_sse_inv_256;     break;
-                case  512: plan->xform = okfft_sse_inv_512;     break;
-                case 1024: plan->xform = okfft_sse_inv_1024;    break;
-                case 2048: plan->xform = okfft_sse_inv_2048;    break;
-                case 4096: plan->xform = okfft_sse_inv_4096;    break;
-                case 8192: plan->xform = okfft_sse_inv_8192;    break;
-                default:   plan->xform = okfft_sse_inv_generic; break;
-            }
-            #endif
-        }
-    }
+    plan->offsets = okfft_init_offsets(N);
+    okfft_init_indices(plan->is, N);
+    okfft_init_twiddles_d(plan, N, dir == OKFFT_DIR_INVERSE);
 
+    plan->xform = dir == OKFFT_DIR_FORWARD ? kernels->fwd_d : kernels->inv_d;
     return plan;
 }
 
-okfft_plan_t *okfft_create_plan_real(size_t N, OKFFT_DIRECTION dir)
+okfft_plan_d_t *okfft_create_plan_d(size_t N, OKFFT_DIRECTION dir)
 {
-    if (N < 4)
-    {
-        OKFFT_LOG("Smallest supported real transform size is 4, got %zu!\n", N);
-        return NULL;
-    }
+    return okfft_pack_plan_d(okfft_new_plan_d(N, dir));
+}
 
+okfft_plan_d_t *okfft_create_plan_real_d(size_t N, OKFFT_DIRECTION dir)
+{
     if (N < 64)
     {
-        OKFFT_LOG("TODO: smaller real xforms than 64!");
+        OKFFT_LOG("Smallest supported double real transform size is 64, got %zu!\n", N);
         return NULL;
     }
 
-    okfft_plan_t *plan = okfft_create_plan(N / 2, dir);
+    okfft_plan_d_t *plan = okfft_new_plan_d(N / 2, dir);
 
     if (plan)
-        okfft_init_real_coeffs(plan, N, dir == OKFFT_DIR_INVERSE);
+        okfft_init_real_coeffs_d(plan, N, dir == OKFFT_DIR_INVERSE);
 
-    return plan;
+    return okfft_pack_plan_d(plan);
 }
 
-okfft_buffer_t okfft_create_buffer(size_t N)
+okfft_buffer_d_t okfft_create_buffer_d(size_t N)
 {
-    okfft_buffer_t s = { (float *) OKFFT_ALLOC_BUFFER((N + 2) * sizeof(float)) };
+    okfft_buffer_d_t s = { (double *) OKFFT_ALLOC_BUFFER((N + 2) * sizeof(double)) };
     return s;
 }
 
-void okfft_destroy_buffer(okfft_buffer_t *s)
+void okfft_destroy_buffer_d(okfft_buffer_d_t *s)
 {
     OKFFT_FREE_BUFFER(s->buffer);
     s->buffer = NULL;
 }
 
-void okfft_destroy_plan(okfft_plan_t *plan)
+void okfft_destroy_plan_d(okfft_plan_d_t *plan)
 {
-    if (plan->ws)       OKFFT_FREE_ALIGNED_DATA(plan->ws);
-    if (plan->ws_is)    OKFFT_FREE_ALIGNED_DATA(plan->ws_is);
-    if (plan->offsets)  OKFFT_FREE_DATA(plan->offsets);
-    
-    if (plan->A)
-    {
-        // real xform, free real coeffs
-        OKFFT_FREE_ALIGNED_DATA(plan->A);
-        OKFFT_FREE_ALIGNED_DATA(plan->B);
-    }
-
-    memset(plan, 0, sizeof(*plan));
+    okfft_free_plan_d(plan);
 }
 
-void okfft_execute(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+void okfft_execute_d(const okfft_plan_d_t *plan, double *__restrict output, const double *__restrict input)
 {
     plan->xform(plan, output, input);
 }
 
-void okfft_execute_real(const okfft_plan_t *plan, okfft_buffer_t *state, float *__restrict output, const float *__restrict input)
+void okfft_execute_real_d(const okfft_plan_d_t *plan, okfft_buffer_d_t *state, double *__restrict output, const double *__restrict input)
 {
-    #if OKFFT_HAS_AVX 
-    if (plan->flags & OKFFT_FLAG_AVX)
+    if (plan->flags & OKFFT_FLAG_INVERSE_XFORM)
     {
-        if (plan->flags & OKFFT_FLAG_INVERSE_XFORM)
-        {
-            okfft_avx_inv_real(state->buffer, input, plan->A, plan->B, plan->N << 1);
-            plan->xform(plan, output, state->buffer);
-        }
-        else
-        {
-            plan->xform(plan, state->buffer, input);
-            okfft_avx_fwd_real(output, state->buffer, plan->A, plan->B, plan->N << 1);
-        }
+        okfft_sse_d_inv_real(state->buffer, input, plan->A, plan->B, plan->N << 1);
+        plan->xform(plan, output, state->buffer);
     }
     else
-    #endif
     {
-        #ifdef OKFFT_HAS_SSE
-        if (plan->flags & OKFFT_FLAG_INVERSE_XFORM)
-        {
-            okfft_sse_inv_real(state->buffer, input, plan->A, plan->B, plan->N << 1);
-            plan->xform(plan, output, state->buffer);
-        }
-        else
-        {
-            plan->xform(plan, state->buffer, input);
-            okfft_sse_fwd_real(output, state->buffer, plan->A, plan->B, plan->N << 1);
-        }
-        #endif
+        plan->xform(plan, state->buffer, input);
+        okfft_sse_d_fwd_real(output, state->buffer, plan->A, plan->B, plan->N << 1);
     }
 }
 
 // calculation functions
 
-static void okfft_elab_odd(ptrdiff_t *const offs, size_t N, ptrdiff_t in_offs, ptrdiff_t out_offs, ptrdiff_t stride)
+// The split radix recursion as a work list: a sub xform of N points at input offset 'in' (in complex values, with
+// stride 'stride') and output offset 'out' is an N / 2 point one and two N / 4 point ones, down to the leafs of 8 and
+// 16 points. The leafs start at the inputs in = -k ... N / 8 - 1 - k, each once, and the xform runs them in the order
+// of in mod N, so the leaf starting at 'in' is leaf in mod N / 8: O(N), no sort and no temp table.
+static uint32_t *okfft_init_offsets(size_t N)
 {
-    if (N <= 16)
+    const uint32_t *mapped = okfft_wisdom_offsets(N);
+    if (mapped)
+        return (uint32_t *) mapped;
+
+    const size_t mask = N / leaf_N - 1;
+    uint32_t *offsets = (uint32_t *) OKFFT_ALLOC_DATA(N / leaf_N * sizeof(uint32_t));
+
+    // output offsets in floats, a negative 'in' wraps mod N / 8 in two's complement
+#define okfft_set_offset(in, out) offsets[(size_t) (in) & mask] = (uint32_t) (2 * (out))
+
+    okfft_set_offset(0, 0);
+    okfft_set_offset((ptrdiff_t) N / 16, 8);
+    okfft_set_offset((ptrdiff_t) N / 32, 16);
+    okfft_set_offset(-(ptrdiff_t) N / 32, 24);
+
+    struct okfft_elab_t { ptrdiff_t N, in, out, stride; };
+
+    // depth first, at most 2 sub xforms per level are waiting
+    okfft_elab_t stack[2 * 64 + 3];
+    size_t top = 0;
+
+    ptrdiff_t stride = 1;
+    for (ptrdiff_t n = (ptrdiff_t) N; n > 32; n /= 2, stride *= 2)
     {
-        offs[(out_offs / 4) + 0] = in_offs * 2;
-        offs[(out_offs / 4) + 1] = out_offs;
+        stack[top++] = { n / 4,  stride,     n / 2, stride * 4 };
+        stack[top++] = { n / 4, -stride, 3 * n / 4, stride * 4 };
 
-        if (N == 16)
+        while (top)
         {
-            offs[(out_offs / 4) + 2] = (in_offs + stride) * 2;
-            offs[(out_offs / 4) + 3] = out_offs + 8;
+            const okfft_elab_t e = stack[--top];
+
+            if (e.N <= 16)
+            {
+                okfft_set_offset(e.in, e.out);
+
+                if (e.N == 16)
+                    okfft_set_offset(e.in + e.stride, e.out + 8);
+            }
+            else
+            {
+                stack[top++] = { e.N / 2, e.in,            e.out,                 e.stride * 2 };
+                stack[top++] = { e.N / 4, e.in + e.stride, e.out +     e.N / 2,   e.stride * 4 };
+                stack[top++] = { e.N / 4, e.in - e.stride, e.out + 3 * e.N / 4,   e.stride * 4 };
+            }
         }
     }
-    else
-    {
-        okfft_elab_odd(offs, N / 2, in_offs,          out_offs,               stride * 2);
-        okfft_elab_odd(offs, N / 4, in_offs + stride, out_offs +     (N / 2), stride * 4);
-        okfft_elab_odd(offs, N / 4, in_offs - stride, out_offs + 3 * (N / 4), stride * 4);
-    }
-}
 
-static void okfft_elab_even(ptrdiff_t *const offs, ptrdiff_t N)
-{
-    offs[0] = 0;
-    offs[1] = 0;
-    offs[2] = N / 8;
-    offs[3] = 8;
-    offs[4] = (N / 16);
-    offs[5] = 16;
-    offs[6] = -(N / 16);
-    offs[7] = 24;
+#undef okfft_set_offset
 
-    ptrdiff_t stride = 1;
-    for (; N > 32; N /= 2, stride *= 2)
-    {
-        okfft_elab_odd(offs, N / 4,  stride,     (N / 2), stride * 4);
-        okfft_elab_odd(offs, N / 4, -stride, 3 * (N / 4), stride * 4);
-    }
+    return offsets;
 }
 
-static int okfft_offset_cmp(const void *pa, const void *pb)
+static void okfft_init_indices(ptrdiff_t *is, size_t N)
 {
-    ptrdiff_t a = *(const ptrdiff_t *)pa;
-    ptrdiff_t b = *(const ptrdiff_t *)pb;
-    return (a > b) - (a < b);
+    const size_t N2 = N >> 1;
+    const size_t N4 = N >> 2;
+
+    is[0] = 0;
+    is[1] = N;
+    is[2] = N2;
+    is[3] = N2 * 3;
+    is[4] = N4;
+    is[5] = N4 * 5;
+    is[6] = N4 * 7;
+    is[7] = N4 * 3;
 }
 
-static void okfft_init_offsets(okfft_plan_t *plan, size_t N)
+// The in place leaf pass wants the 16 inputs of leaf j where it writes its outputs ('offsets[2j]' and 'offsets[2j + 1]').
+// The inputs of 4 consecutive leafs come from 8 lines of 64 bytes (one per input index 'is[k]'), which the xform
+// shuffles within the lines first (okfft_xf_layout.cpp). What is left is a permutation of whole lines, stored as its cycles.
+static void okfft_init_inplace_cycles(okfft_plan_t *plan, size_t N)
 {
-    const size_t offset_count = N / leaf_N;
-    ptrdiff_t *offsets = (ptrdiff_t *) OKFFT_ALLOC_DATA(offset_count * sizeof(ptrdiff_t));
-    ptrdiff_t *tmp = (ptrdiff_t *) OKFFT_ALLOC_TEMP_DATA(2 * offset_count * sizeof(ptrdiff_t));
+    const size_t lines = N / 8;
+    uint32_t *dst = (uint32_t *) OKFFT_ALLOC_TEMP_DATA(lines * sizeof(uint32_t));
 
-    okfft_elab_even(tmp, (ptrdiff_t) N);
-
-    for (size_t i = 0; i < 2 * offset_count; i += 2)
+    // line 'is[2c + h] / 16 + t' holds the inputs 4h .. 4h + 3 of leaf 4t + c
+    for (size_t t = 0; t < N / 64; t++)
     {
-        if (tmp[i] < 0)
-            tmp[i] += N;
+        for (size_t k = 0; k < 8; k++)
+        {
+            const size_t c = k / 2, h = k % 2;
+            dst[plan->is[k] / 16 + t] = (uint32_t) (plan->offsets[2 * (4 * t + c) + h] / 16);
+        }
     }
 
-    qsort(tmp, offset_count, 2 * sizeof(*tmp), okfft_offset_cmp);
+    // moved lines are marked by pointing them to themselves
+    size_t size = 0;
+    uint32_t *cycles = (uint32_t *) OKFFT_ALLOC_DATA((lines + lines / 2) * sizeof(uint32_t));
 
-    for (size_t i = 0; i < offset_count; i++)
-        offsets[i] = 2 * tmp[2 * i + 1];
+    for (size_t i = 0; i < lines; i++)
+    {
+        if (dst[i] == i)
+            continue;
 
-    OKFFT_FREE_TEMP_DATA(tmp);
-    plan->offsets = offsets;
-}
+        const size_t start = size++;
+        size_t line = i;
+        do
+        {
+            const size_t next = dst[line];
+            cycles[size++] = (uint32_t) line;
+            dst[line] = (uint32_t) line;
+            line = next;
+        } while (line != i);
 
-static void okfft_init_indices(okfft_plan_t *p, size_t N)
-{
-    const size_t N2 = N >> 1;
-    const size_t N4 = N >> 2;
+        cycles[start] = (uint32_t) (size - start - 1);
+    }
 
-    p->is[0] = 0;
-    p->is[1] = N;
-    p->is[2] = N2;
-    p->is[3] = N2 * 3;
-    p->is[4] = N4;
-    p->is[5] = N4 * 5;
-    p->is[6] = N4 * 7;
-    p->is[7] = N4 * 3;
+    OKFFT_FREE_TEMP_DATA(dst);
+
+    plan->ip_cycles = cycles;
+    plan->ip_cycles_size = size;
 }
 
 static inline size_t okfft_ilog2(size_t N)
@@ -585,58 +1662,198 @@ static void okfft_generate_twiddle_table(cplx *table, size_t table_size)
     const __m128d *__restrict ct = (const __m128d *) &cos_sin_table[4 * offset];
     const double *__restrict hs  = (const double *) &half_secant[2 * offset];
 
-    OKFFT_ALIGN(16) __m128d w[32];
-    OKFFT_ALIGN(16) __m128d h[32];
+    OKFFT_ALIGN(16) __m128d w[32];
+    OKFFT_ALIGN(16) __m128d h[32];
+
+    // init from lut
+    for (size_t i = 0; i <= log2; i++)
+    {
+        w[i] = ct[2 * i];
+        h[i] = _mm_set1_pd(hs[2 * i]); // duplicate the high part
+    }
+
+    static const __m128d sign_swap = { 0.0, -0.0 };
+
+    // generate sin / cos tables with max .5 ulp error
+    for (int i = 1; i < (int) table_size / 2; i++)
+    {
+        log2 = okfft_ilog2(i); // trailing zeros in index        
+        __m128d wvl = w[log2];
+
+        __m128d v1 = _mm_shuffle_pd(wvl, wvl, 1);
+        __m128d v0 = _mm_or_pd(wvl, sign_swap);
+                v1 = _mm_or_pd(v1,  sign_swap);
+
+        _mm_storel_pi((__m64 *) &table[i + 0],          _mm_cvtpd_ps(v0));
+        _mm_storel_pi((__m64 *) &table[table_size - i], _mm_cvtpd_ps(v1));
+
+        // skip and find next trailing zero
+        offset = log2 + 2 + okfft_ilog2(~i >> (log2 + 2));
+        w[log2] = _mm_mul_pd(h[log2], _mm_add_pd(w[log2 + 1], w[offset]));
+    }
+
+    table[table_size / 2][0] =  0.70710677f;
+    table[table_size / 2][1] = -0.70710677f;
+}
+
+// Twiddles shared by all plans of a direction and layout. Level i of the table holds the radix 8 factors of the
+// 16 << i point pass and the levels are stored in increasing size, so the table of N is a prefix of the table of any
+// larger size: every plan points into the current table of its kind, which is only replaced (at least 4x larger) by
+// a plan too large for it. Tables are freed with the last plan using them.
+struct okfft_twiddles_t
+{
+    float *ws;
+    ptrdiff_t *ws_is;
+    size_t N;
+    size_t refs;                        // plans, plus one while it's the current table
+    bool mapped;                        // 'ws' and 'ws_is' are in a wisdom file
+};
+
+static std::mutex okfft_twiddles_lock;
+static okfft_twiddles_t *okfft_twiddles_current[2][3]; // [inverse][sse, avx x8, avx512 x16 layout]
+
+static okfft_twiddles_t *okfft_create_twiddles(size_t N, bool is_inverse, size_t flags);
+
+// called with the lock held
+static void okfft_unref_twiddles(okfft_twiddles_t *t)
+{
+    if (--t->refs)
+        return;
+
+    if (!t->mapped)
+    {
+        OKFFT_FREE_ALIGNED_DATA(t->ws);
+        OKFFT_FREE_ALIGNED_DATA(t->ws_is);
+    }
+
+    OKFFT_FREE_DATA(t);
+}
+
+static size_t okfft_twiddles_layout(size_t flags)
+{
+    return (flags & OKFFT_FLAG_AVX512) ? 2 : (flags & OKFFT_FLAG_AVX) ? 1 : 0;
+}
+
+// a table of at least N points from an imported wisdom file, NULL if there is none
+static okfft_twiddles_t *okfft_map_twiddles(size_t N, bool is_inverse, size_t layout)
+{
+    const ptrdiff_t *ws_is;
+    size_t table_N;
+
+    const float *ws = okfft_wisdom_twiddles(N, is_inverse, layout, &ws_is, &table_N);
+    if (!ws)
+        return NULL;
+
+    okfft_twiddles_t *t = (okfft_twiddles_t *) OKFFT_ALLOC_DATA(sizeof(*t));
+    t->ws     = (float *) ws;
+    t->ws_is  = (ptrdiff_t *) ws_is;
+    t->N      = table_N;
+    t->refs   = 1;
+    t->mapped = true;
+    return t;
+}
+
+static void okfft_init_twiddles(okfft_plan_t *plan, size_t N, bool is_inverse)
+{
+    const size_t layout = okfft_twiddles_layout(plan->flags);
+
+    std::lock_guard<std::mutex> lock(okfft_twiddles_lock);
 
-    // init from lut
-    for (size_t i = 0; i <= log2; i++)
+    okfft_twiddles_t *&t = okfft_twiddles_current[is_inverse][layout];
+    if (!t || t->N < N)
     {
-        w[i] = ct[2 * i];
-        h[i] = _mm_set1_pd(hs[2 * i]); // duplicate the high part
+        size_t size = t ? 4 * t->N : twiddles_min_N;
+        size = size > N ? size : N;
+        size = size < max_N ? size : max_N; // no plan needs more
+
+        if (t)
+            okfft_unref_twiddles(t);
+
+        t = okfft_map_twiddles(N, is_inverse, layout);
+        if (!t)
+            t = okfft_create_twiddles(size, is_inverse, plan->flags);
     }
 
-    static const __m128d sign_swap = { 0.0, -0.0 };
+    t->refs++;
+    plan->twiddles = t;
+    plan->ws = t->ws;
+    plan->ws_is = t->ws_is;
+}
 
-    // generate sin / cos tables with max .5 ulp error
-    for (int i = 1; i < (int) table_size / 2; i++)
-    {
-        log2 = okfft_ilog2(i); // trailing zeros in index        
-        __m128d wvl = w[log2];
+static void okfft_retain_twiddles(okfft_twiddles_t *t)
+{
+    std::lock_guard<std::mutex> lock(okfft_twiddles_lock);
+    t->refs++;
+}
 
-        __m128d v1 = _mm_shuffle_pd(wvl, wvl, 1);
-        __m128d v0 = _mm_or_pd(wvl, sign_swap);
-                v1 = _mm_or_pd(v1,  sign_swap);
+static void okfft_release_twiddles(okfft_twiddles_t *t)
+{
+    std::lock_guard<std::mutex> lock(okfft_twiddles_lock);
+    okfft_unref_twiddles(t);
+}
 
-        _mm_storel_pi((__m64 *) &table[i + 0],          _mm_cvtpd_ps(v0));
-        _mm_storel_pi((__m64 *) &table[table_size - i], _mm_cvtpd_ps(v1));
+// the key of the shared table the plan reads (its first 'ws_size' floats), for 'okfft_export_plans'
+bool okfft_plan_twiddles(const okfft_plan_t *plan, bool *is_inverse, size_t *layout, size_t *ws_size, size_t *lut_count)
+{
+    if (!plan->twiddles)
+        return false;
 
-        // skip and find next trailing zero
-        offset = log2 + 2 + okfft_ilog2(~i >> (log2 + 2));
-        w[log2] = _mm_mul_pd(h[log2], _mm_add_pd(w[log2 + 1], w[offset]));
-    }
+    *is_inverse = (plan->flags & OKFFT_FLAG_INVERSE_XFORM) != 0;
+    *layout = okfft_twiddles_layout(plan->flags);
+    *ws_size = okfft_twiddles_size(plan->N, lut_count);
+    return true;
+}
 
-    table[table_size / 2][0] =  0.70710677f;
-    table[table_size / 2][1] = -0.70710677f;
+// the power of two xform a plan of the key runs through the leaf pass, whose offsets it needs (the larger dimension
+// of a four step plan, L of a bluestein plan), 0 if the create functions refuse the key, for 'okfft_import_plans'
+size_t okfft_plan_offsets_N(size_t N, OKFFT_PLAN_KIND kind)
+{
+    if (N < 2 || N > max_N)
+        return 0;
+
+    const bool is_pow2 = !(N & (N - 1));
+
+    if (kind == OKFFT_KIND_REAL)
+        return is_pow2 && N >= 4 ? N / 2 : 0;
+
+    if (kind == OKFFT_KIND_FOURSTEP && is_pow2 && N >= fourstep_N)
+        return N >> (okfft_ilog2(N) / 2);
+
+    size_t M = 1;
+    while ((N / M) % 5 == 0) M *= 5;
+    while ((N / M) % 3 == 0) M *= 3;
+
+    if (!((N / M) & (N / M - 1)))
+        return N / M;
+
+    size_t L = 4;
+    while (L < 2 * N - 1)
+        L *= 2;
+
+    return L <= max_N ? L : 0;
 }
 
-static void okfft_init_twiddles(okfft_plan_t *plan, size_t N, bool is_inverse)
+static okfft_twiddles_t *okfft_create_twiddles(size_t N, bool is_inverse, size_t flags)
 {
 #define dup_re(x) _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0))
 #define dup_im(x) _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1))
 
+// the factors 'c' and 'c + 1' of the table, 's' apart
+#define load_w(c, s) _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) tmp[(c) * (s)]), \
+                                  (const __m64 *) tmp[((c) + 1) * (s)])
+
     __m128 muli_sign;
     if (is_inverse)
         muli_sign = _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f);
     else
         muli_sign = _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f);
 
-    size_t lut_count = okfft_ilog2(N / leaf_N);
-    size_t lut_size  = 16;
-    for (size_t i = 1; i < lut_count; i++)
-        lut_size += 48 * (1 << (i - 1));
+    size_t lut_count;
+    size_t lut_size = okfft_twiddles_size(N, &lut_count);
 
     cplx *twiddles = (cplx *) OKFFT_ALLOC_ALIGNED_DATA(lut_size * sizeof(float));
     ptrdiff_t *twiddle_indices = (ptrdiff_t *) OKFFT_ALLOC_ALIGNED_DATA(lut_count * sizeof(ptrdiff_t));
+    twiddle_indices[0] = 0; // the kernels never read it, but the wisdom files do
     
     cplx *w = twiddles;
 
@@ -650,7 +1867,15 @@ static void okfft_init_twiddles(okfft_plan_t *plan, size_t N, bool is_inverse)
     size_t stride = 1ull << (lut_count - 1);
 
     #ifdef OKFFT_HAS_AVX
-        const bool needs_reorder = okfft_cpu_has_avx();
+        const bool needs_reorder = (flags & OKFFT_FLAG_AVX) != 0;
+    #endif
+
+    #ifdef OKFFT_HAS_AVX512
+        const bool needs_reorder_x16 = (flags & OKFFT_FLAG_AVX512) != 0;
+    #endif
+
+    #if !defined(OKFFT_HAS_AVX) && !defined(OKFFT_HAS_AVX512)
+        (void) flags; // sse layout only
     #endif
 
     {
@@ -700,36 +1925,52 @@ static void okfft_init_twiddles(okfft_plan_t *plan, size_t N, bool is_inverse)
     for (size_t i = 1; i < lut_count; i++) 
     {
         twiddle_indices[i] = w - twiddles;
-        
-        cplx *w0 = (cplx *) OKFFT_ALLOC_TEMP_ALIGNED_DATA(n / 8 * sizeof(cplx));
-        cplx *w1 = (cplx *) OKFFT_ALLOC_TEMP_ALIGNED_DATA(n / 8 * sizeof(cplx));
-        cplx *w2 = (cplx *) OKFFT_ALLOC_TEMP_ALIGNED_DATA(n / 8 * sizeof(cplx));
-            
-        for (size_t j = 0; j < n / 8; j++)
-        {
-            w0[j][0] = tmp[2 * j * stride][0];
-            w0[j][1] = tmp[2 * j * stride][1];
 
-            w1[j][0] = tmp[j * stride][0];
-            w1[j][1] = tmp[j * stride][1];
+        // the pass reads w0[c] = tmp[2 c stride], w1[c] = tmp[c stride] and w2[c] = tmp[(c + n / 8) stride], loaded
+        // straight from the table in pairs (float j is factor c = j / 2)
 
-            w2[j][0] = tmp[(j + (n / 8)) * stride][0];
-            w2[j][1] = tmp[(j + (n / 8)) * stride][1];
-        }
+        #ifdef OKFFT_HAS_AVX512
+        if (needs_reorder_x16 && n >= 64)
+        {
+            // AVX512 x16 reorder, the n = 32 pass is too narrow for zmm and keeps the x8 layout
+            const size_t w_first[3]  = { 0, 0, n / 8 };
+            const size_t w_stride[3] = { 2 * stride, stride, stride };
 
+            for (size_t j = 0; j < n / 4; j += 16)
+            {
+                float *wj = (float *) w + 6 * j;
+
+                for (size_t k = 0; k < 3; k++)
+                {
+                    for (size_t l = 0; l < 4; l++)
+                    {
+                        __m128 t  = load_w(w_first[k] + j / 2 + 2 * l, w_stride[k]);
+                        __m128 re = dup_re(t);
+                        __m128 im = dup_im(t);
+
+                        im = _mm_xor_ps(im, muli_sign);
+
+                        _mm_store_ps(wj + 32 * k +      4 * l, re);
+                        _mm_store_ps(wj + 32 * k + 16 + 4 * l, im);
+                    }
+                }
+            }
+        }
+        else
+        #endif
         #ifdef OKFFT_HAS_AVX
         if (needs_reorder)
         {
             // AVX x8 reorder
-            for (size_t j = 0; j < n / 8; j += 8)
+            for (size_t j = 0; j < n / 4; j += 8)
             {
-                __m128 t00 = _mm_load_ps((float *)w0 + j);
-                __m128 t10 = _mm_load_ps((float *)w1 + j);
-                __m128 t20 = _mm_load_ps((float *)w2 + j);
+                __m128 t00 = load_w(j / 2,              2 * stride);
+                __m128 t10 = load_w(j / 2,              stride);
+                __m128 t20 = load_w(j / 2 + n / 8,      stride);
 
-                __m128 t01 = _mm_load_ps((float *)w0 + j + 4);
-                __m128 t11 = _mm_load_ps((float *)w1 + j + 4);
-                __m128 t21 = _mm_load_ps((float *)w2 + j + 4);
+                __m128 t01 = load_w(j / 2 + 2,          2 * stride);
+                __m128 t11 = load_w(j / 2 + 2,          stride);
+                __m128 t21 = load_w(j / 2 + 2 + n / 8,  stride);
 
                 __m128 re00 = dup_re(t00);
                 __m128 re10 = dup_re(t10);
@@ -777,11 +2018,11 @@ static void okfft_init_twiddles(okfft_plan_t *plan, size_t N, bool is_inverse)
         else
         #endif
         {
-            for (size_t j = 0; j < n / 8; j += 4) 
+            for (size_t j = 0; j < n / 4; j += 4)
             {
-                __m128 t0 = _mm_load_ps((float *) w0 + j);
-                __m128 t1 = _mm_load_ps((float *) w1 + j);
-                __m128 t2 = _mm_load_ps((float *) w2 + j);
+                __m128 t0 = load_w(j / 2,         2 * stride);
+                __m128 t1 = load_w(j / 2,         stride);
+                __m128 t2 = load_w(j / 2 + n / 8, stride);
 
                 __m128 re0 = dup_re(t0);
                 __m128 re1 = dup_re(t1);
@@ -808,21 +2049,320 @@ static void okfft_init_twiddles(okfft_plan_t *plan, size_t N, bool is_inverse)
 
         w += n / 8 * 3 * 2;
 
-        OKFFT_FREE_TEMP_ALIGNED_DATA(w0);
-        OKFFT_FREE_TEMP_ALIGNED_DATA(w1);
-        OKFFT_FREE_TEMP_ALIGNED_DATA(w2);
-
         n *= 2;
         stride >>= 1;
     }
     
     OKFFT_FREE_TEMP_ALIGNED_DATA(tmp);
-    
-    plan->ws    = (float *) twiddles;
-    plan->ws_is = twiddle_indices;
+
+    okfft_twiddles_t *t = (okfft_twiddles_t *) OKFFT_ALLOC_DATA(sizeof(*t));
+    t->ws     = (float *) twiddles;
+    t->ws_is  = twiddle_indices;
+    t->N      = N;
+    t->refs   = 1;
+    t->mapped = false;
+    return t;
 
 #undef dup_re
 #undef dup_im
+#undef load_w
+}
+
+typedef double dbl_cplx[2];
+
+// same as 'okfft_generate_twiddle_table', without the final rounding to float
+static void okfft_generate_twiddle_table_d(dbl_cplx *table, size_t table_size)
+{
+    table[0][0] =  1.0;
+    table[0][1] = -0.0;
+
+    size_t log2   = okfft_ilog2(table_size);
+    size_t offset = 32 - log2;
+
+    const __m128d *__restrict ct = (const __m128d *) &cos_sin_table[4 * offset];
+    const double *__restrict hs  = (const double *) &half_secant[2 * offset];
+
+    OKFFT_ALIGN(16) __m128d w[32];
+    OKFFT_ALIGN(16) __m128d h[32];
+
+    // init from lut
+    for (size_t i = 0; i <= log2; i++)
+    {
+        w[i] = ct[2 * i];
+        h[i] = _mm_set1_pd(hs[2 * i]); // duplicate the high part
+    }
+
+    static const __m128d sign_swap = { 0.0, -0.0 };
+
+    for (int i = 1; i < (int) table_size / 2; i++)
+    {
+        log2 = okfft_ilog2(i); // trailing zeros in index
+        __m128d wvl = w[log2];
+
+        __m128d v1 = _mm_shuffle_pd(wvl, wvl, 1);
+        __m128d v0 = _mm_or_pd(wvl, sign_swap);
+                v1 = _mm_or_pd(v1,  sign_swap);
+
+        _mm_store_pd(table[i + 0],          v0);
+        _mm_store_pd(table[table_size - i], v1);
+
+        // skip and find next trailing zero
+        offset = log2 + 2 + okfft_ilog2(~i >> (log2 + 2));
+        w[log2] = _mm_mul_pd(h[log2], _mm_add_pd(w[log2 + 1], w[offset]));
+    }
+
+    table[table_size / 2][0] =  0.70710678118654752440;
+    table[table_size / 2][1] = -0.70710678118654752440;
+}
+
+// two complex twiddles in the sse layout, { re0, re0, re1, re1 } { im0, -im0, im1, -im1 } (signs flipped for the inverse)
+static void okfft_store_twiddles_d(double *w, const dbl_cplx a, const dbl_cplx b, double sign)
+{
+    w[0] =  a[0];
+    w[1] =  a[0];
+    w[2] =  b[0];
+    w[3] =  b[0];
+    w[4] =  sign * a[1];
+    w[5] = -sign * a[1];
+    w[6] =  sign * b[1];
+    w[7] = -sign * b[1];
+}
+
+// floats (doubles) in the twiddle table of N, 'lut_count' levels
+size_t okfft_twiddles_size(size_t N, size_t *lut_count)
+{
+    *lut_count = okfft_ilog2(N / leaf_N);
+
+    size_t lut_size = 16;
+    for (size_t i = 1; i < *lut_count; i++)
+        lut_size += 48 * (1 << (i - 1));
+
+    return lut_size;
+}
+
+// the double kernels all share the sse twiddle layout of 'okfft_init_twiddles'
+static void okfft_init_twiddles_d(okfft_plan_d_t *plan, size_t N, bool is_inverse)
+{
+    const double sign = is_inverse ? -1.0 : 1.0;
+
+    size_t lut_count;
+    size_t lut_size = okfft_twiddles_size(N, &lut_count);
+
+    double *twiddles = (double *) OKFFT_ALLOC_ALIGNED_DATA(lut_size * sizeof(double));
+    ptrdiff_t *twiddle_indices = (ptrdiff_t *) OKFFT_ALLOC_ALIGNED_DATA(lut_count * sizeof(ptrdiff_t));
+
+    double *w = twiddles;
+
+    // calculate factors
+    size_t n = (size_t) leaf_N * 2;
+    size_t m = (size_t) leaf_N << (lut_count - 2);
+
+    dbl_cplx *tmp = (dbl_cplx *) OKFFT_ALLOC_TEMP_ALIGNED_DATA(m * sizeof(dbl_cplx));
+    okfft_generate_twiddle_table_d(tmp, m);
+
+    size_t stride = 1ull << (lut_count - 1);
+
+    okfft_store_twiddles_d(w + 0, tmp[0],          tmp[stride],     sign);
+    okfft_store_twiddles_d(w + 8, tmp[2 * stride], tmp[3 * stride], sign);
+
+    w += 16;
+    n *= 2;
+    stride >>= 1;
+
+    for (size_t i = 1; i < lut_count; i++)
+    {
+        twiddle_indices[i] = (w - twiddles) / 2;
+
+        for (size_t j = 0; j < n / 8; j += 2)
+        {
+            okfft_store_twiddles_d(w +  0, tmp[2 * j * stride],         tmp[2 * (j + 1) * stride],       sign);
+            okfft_store_twiddles_d(w +  8, tmp[j * stride],             tmp[(j + 1) * stride],           sign);
+            okfft_store_twiddles_d(w + 16, tmp[(j + n / 8) * stride],   tmp[(j + 1 + n / 8) * stride],   sign);
+            w += 24;
+        }
+
+        n *= 2;
+        stride >>= 1;
+    }
+
+    OKFFT_FREE_TEMP_ALIGNED_DATA(tmp);
+
+    plan->ws    = twiddles;
+    plan->ws_is = twiddle_indices;
+}
+
+// W_n^k = exp(-2 pi i k / n), computed in double for arbitrary n
+static void okfft_mixed_twiddle(double w[2], size_t k, size_t n)
+{
+    const double phi = (2.0 * 3.14159265358979323846264338327950288 * (double) (k % n)) / (double) n;
+    w[0] =  cos(phi);
+    w[1] = -sin(phi);
+}
+
+// complex twiddles of the radix 3 / 5 passes
+static size_t okfft_mixed_twiddles_count(const okfft_plan_t *plan)
+{
+    size_t count = 0;
+    for (size_t i = 0, n = plan->M; i < plan->radix_count; n /= plan->radix[i++])
+        count += (plan->radix[i] - 1) * (n / plan->radix[i]);
+
+    return count;
+}
+
+// radix pass twiddles as { re, re, re, re } { -im, im, -im, im } (for the constant complex multiply)
+// followed by the N / M x M row twiddles, interleaved complex
+static void okfft_init_mixed_twiddles(okfft_plan_t *plan, size_t N, bool is_inverse)
+{
+    const size_t M = plan->M;
+    const size_t P = N / M;
+    const double sign = is_inverse ? -1.0 : 1.0;
+
+    float *ws = (float *) OKFFT_ALLOC_ALIGNED_DATA(8 * okfft_mixed_twiddles_count(plan) * sizeof(float));
+    plan->mr_ws = ws;
+
+    for (size_t i = 0, n = M; i < plan->radix_count; n /= plan->radix[i++])
+    {
+        const size_t R = plan->radix[i];
+
+        for (size_t p = 0; p < n / R; p++)
+        {
+            for (size_t t = 1; t < R; t++)
+            {
+                double w[2];
+                okfft_mixed_twiddle(w, p * t, n);
+
+                ws[0] = ws[1] = ws[2] = ws[3] = (float) w[0];
+                ws[4] = ws[6] = (float) (-sign * w[1]);
+                ws[5] = ws[7] = (float) ( sign * w[1]);
+                ws += 8;
+            }
+        }
+    }
+
+    if (P == 1)
+        return;
+
+    float *dit = (float *) OKFFT_ALLOC_ALIGNED_DATA(2 * N * sizeof(float));
+    plan->mr_dit = dit;
+
+    for (size_t n2 = 0; n2 < M; n2++)
+    {
+        for (size_t k1 = 0; k1 < P; k1++)
+        {
+            double w[2];
+            okfft_mixed_twiddle(w, n2 * k1, N);
+
+            dit[2 * (n2 * P + k1) + 0] = (float) w[0];
+            dit[2 * (n2 * P + k1) + 1] = (float) (sign * w[1]);
+        }
+    }
+}
+
+// W_N^m for m < N as lo[m & (L - 1)] * hi[m >> shift] (L = 2^shift about sqrt(N)), 2 (L + N / L) floats
+// instead of a full N point table, interleaved complex
+static void okfft_init_fourstep_twiddles(okfft_plan_t *plan, size_t N, bool is_inverse)
+{
+    const size_t shift = (okfft_ilog2(N) + 1) / 2;
+    const size_t L = (size_t) 1 << shift;
+    const double sign = is_inverse ? -1.0 : 1.0;
+
+    float *lo = (float *) OKFFT_ALLOC_ALIGNED_DATA(2 * (L + N / L) * sizeof(float));
+    float *hi = lo + 2 * L;
+
+    for (size_t k = 0; k < L; k++)
+    {
+        double w[2];
+        okfft_mixed_twiddle(w, k, N);
+
+        lo[2 * k + 0] = (float) w[0];
+        lo[2 * k + 1] = (float) (sign * w[1]);
+    }
+
+    for (size_t k = 0; k < N / L; k++)
+    {
+        double w[2];
+        okfft_mixed_twiddle(w, k * L, N);
+
+        hi[2 * k + 0] = (float) w[0];
+        hi[2 * k + 1] = (float) (sign * w[1]);
+    }
+
+    plan->fs_ws = lo;
+    plan->fs_shift = shift;
+}
+
+// A_k = (1 - i W_N^k) / 2 and B_k = (1 + i W_N^k) / 2 (conj(2 A_k) and conj(2 B_k) for the inverse), k < N / 2
+// per two k: { re, re, re', re' } { -im, im, -im', im' } for A, then the same for B
+static void okfft_init_small_real_coeffs(okfft_plan_t *plan, size_t N, bool is_inverse)
+{
+    float *A = (float *) OKFFT_ALLOC_ALIGNED_DATA(4 * N * sizeof(float));
+
+    for (size_t k = 0; k < N / 2; k++)
+    {
+        // W_N^k = c - i s
+        double w[2];
+        okfft_mixed_twiddle(w, k, N);
+
+        double a[2] = { 0.5 * (1.0 + w[1]), -0.5 * w[0] };
+        double b[2] = { 0.5 * (1.0 - w[1]),  0.5 * w[0] };
+
+        if (is_inverse)
+        {
+            a[0] *= 2.0; a[1] *= -2.0;
+            b[0] *= 2.0; b[1] *= -2.0;
+        }
+
+        float *lut = A + 16 * (k / 2) + 2 * (k & 1);
+
+        lut[ 0] = lut[ 1] = (float)  a[0];
+        lut[ 4] = (float) -a[1];
+        lut[ 5] = (float)  a[1];
+        lut[ 8] = lut[ 9] = (float)  b[0];
+        lut[12] = (float) -b[1];
+        lut[13] = (float)  b[1];
+    }
+
+    plan->A = A;
+}
+
+// w_n = exp(-i pi n^2 / N) and the fft of its conjugate, zero padded to L and wrapped around
+// (b_n = b_(L - n) = conj(w_n)), the 1 / L of the inverse xform is folded in
+static void okfft_init_chirp(okfft_plan_t *plan, size_t N, bool is_inverse)
+{
+    const size_t L = plan->sub->N;
+    const double sign = is_inverse ? -1.0 : 1.0;
+
+    float *w = (float *) OKFFT_ALLOC_ALIGNED_DATA(2 * N * sizeof(float));
+    float *b = (float *) OKFFT_ALLOC_TEMP_ALIGNED_DATA(2 * L * sizeof(float));
+    float *B = (float *) OKFFT_ALLOC_ALIGNED_DATA(2 * L * sizeof(float));
+
+    memset(b, 0, 2 * L * sizeof(float));
+
+    for (size_t n = 0; n < N; n++)
+    {
+        // n^2 mod 2N keeps the angle small, W_2N^(n^2)
+        double c[2];
+        okfft_mixed_twiddle(c, (size_t) ((uint64_t) n * n % (2 * N)), 2 * N);
+
+        w[2 * n + 0] = (float) c[0];
+        w[2 * n + 1] = (float) (sign * c[1]);
+
+        b[2 * n + 0] = (float) (c[0] / L);
+        b[2 * n + 1] = (float) (-sign * c[1] / L);
+
+        if (n)
+        {
+            b[2 * (L - n) + 0] = b[2 * n + 0];
+            b[2 * (L - n) + 1] = b[2 * n + 1];
+        }
+    }
+
+    okfft_execute(plan->sub, B, b);
+
+    OKFFT_FREE_TEMP_ALIGNED_DATA(b);
+
+    plan->chirp = w;
+    plan->chirp_ft = B;
 }
 
 static void okfft_init_real_coeffs(okfft_plan_t *plan, size_t N, bool is_inverse)
@@ -839,8 +2379,8 @@ static void okfft_init_real_coeffs(okfft_plan_t *plan, size_t N, bool is_inverse
 
     OKFFT_ALIGN(16) dbl_cplx w[32];
 
-    // init from lut
-    for (size_t i = 0; i <= log2; i++)
+    // init from lut, i < N / 4 never reads past w[log2 - 2] (and the lut ends there)
+    for (size_t i = 0; i + 1 < log2; i++)
     {
         w[i][0] = ct[2 * i][0];
         w[i][1] = ct[2 * i][1];
@@ -920,8 +2460,37 @@ static void okfft_init_real_coeffs(okfft_plan_t *plan, size_t N, bool is_inverse
     }
 
     // reorder A and B to avoid shuffling in the kernel! (avoids 4 cycles?)
+    #ifdef OKFFT_HAS_AVX512
+    if (plan->flags & OKFFT_FLAG_AVX512)
+    {
+        // zmm lane k holds the re / im parts of complex (2k, 2k + 1, 2k + 8, 2k + 9)
+        for (size_t i = 0; i < N; i += 32)
+        {
+            OKFFT_ALIGN(16) float ar[16], ai[16], br[16], bi[16];
+
+            for (size_t k = 0; k < 4; k++)
+            {
+                __m128 a0 = _mm_load_ps(A + i + 4 * k);
+                __m128 a1 = _mm_load_ps(A + i + 4 * k + 16);
+                __m128 b0 = _mm_load_ps(B + i + 4 * k);
+                __m128 b1 = _mm_load_ps(B + i + 4 * k + 16);
+
+                _mm_store_ps(ar + 4 * k, _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_store_ps(ai + 4 * k, _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1)));
+                _mm_store_ps(br + 4 * k, _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_store_ps(bi + 4 * k, _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+
+            memcpy(A + i,      ar, sizeof(ar));
+            memcpy(A + i + 16, ai, sizeof(ai));
+            memcpy(B + i,      br, sizeof(br));
+            memcpy(B + i + 16, bi, sizeof(bi));
+        }
+    }
+    else
+    #endif
     #ifdef OKFFT_HAS_AVX
-    if (okfft_cpu_has_avx())
+    if (plan->flags & OKFFT_FLAG_AVX)
     {
         for (size_t i = 0; i < N; i += 16)
         {
@@ -980,3 +2549,78 @@ static void okfft_init_real_coeffs(okfft_plan_t *plan, size_t N, bool is_inverse
     plan->A = A;
     plan->B = B;
 }
+
+static void okfft_init_real_coeffs_d(okfft_plan_d_t *plan, size_t N, bool is_inverse)
+{
+    double * __restrict A = (double * __restrict) OKFFT_ALLOC_ALIGNED_DATA(N * sizeof(double));
+    double * __restrict B = (double * __restrict) OKFFT_ALLOC_ALIGNED_DATA(N * sizeof(double));
+
+    size_t log2   = okfft_ilog2(N);
+    size_t offset = 34 - log2;
+
+    const dbl_cplx * __restrict ct = (const dbl_cplx *) &cos_sin_table[4 * offset];
+    const double *__restrict hs = (const double *) &half_secant[2 * offset];
+
+    OKFFT_ALIGN(16) dbl_cplx w[32];
+
+    // init from lut, i < N / 4 never reads past w[log2 - 2] (and the lut ends there)
+    for (size_t i = 0; i + 1 < log2; i++)
+    {
+        w[i][0] = ct[2 * i][0];
+        w[i][1] = ct[2 * i][1];
+    }
+
+    // the inverse coeffs are twice the forward ones
+    const double scale = is_inverse ? 1.0 : 0.5;
+
+    A[0] =  scale;
+    A[1] = -scale;
+    B[0] =  scale;
+    B[1] =  scale;
+
+    for (ssize_t i = 1; i < (ssize_t) N / 4; i++)
+    {
+        log2 = okfft_ilog2(i);
+
+        double t1 = scale * w[log2][0];
+        double t0 = scale * (1.0 - w[log2][1]);
+        double t2 = scale * (1.0 + w[log2][1]);
+
+        A[    2 * i + 0] =  t0;
+        A[N - 2 * i + 0] =  t0;
+        A[    2 * i + 1] = -t1;
+        A[N - 2 * i + 1] =  t1;
+
+        B[    2 * i + 0] =  t2;
+        B[N - 2 * i + 0] =  t2;
+        B[    2 * i + 1] =  t1;
+        B[N - 2 * i + 1] = -t1;
+
+        // skip and find next trailing zero
+        offset = log2 + 2 + okfft_ilog2(~i >> (log2 + 2));
+        w[log2][0] = hs[2 * log2] * (w[log2 + 1][0] + w[offset][0]);
+        w[log2][1] = hs[2 * log2] * (w[log2 + 1][1] + w[offset][1]);
+    }
+
+    A[2 * N / 4 + 0] = 0.0;
+    A[2 * N / 4 + 1] = 0.0;
+    B[2 * N / 4 + 0] = 2.0 * scale;
+    B[2 * N / 4 + 1] = 0.0;
+
+    // { re0, im0, re1, im1 } -> { re0, re1, im0, im1 } for the 2 wide real passes
+    for (size_t i = 0; i < N; i += 4)
+    {
+        __m128d a0 = _mm_load_pd(A + i + 0);
+        __m128d a1 = _mm_load_pd(A + i + 2);
+        __m128d b0 = _mm_load_pd(B + i + 0);
+        __m128d b1 = _mm_load_pd(B + i + 2);
+
+        _mm_store_pd(A + i + 0, _mm_unpacklo_pd(a0, a1));
+        _mm_store_pd(A + i + 2, _mm_unpackhi_pd(a0, a1));
+        _mm_store_pd(B + i + 0, _mm_unpacklo_pd(b0, b1));
+        _mm_store_pd(B + i + 2, _mm_unpackhi_pd(b0, b1));
+    }
+
+    plan->A = A;
+    plan->B = B;
+}
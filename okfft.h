@@ -42,12 +42,22 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 // comment out defines to configure
 // #define OKFFT_HAS_AVX 1
+// #define OKFFT_HAS_FMA 1
+// #define OKFFT_HAS_AVX512 1
 #define OKFFT_HAS_SSE 1
 
 #if !defined(OKFFT_HAS_AVX) && !defined(OKFFT_HAS_SSE)
     #error "Must enable avx xforms, sse xforms, or both!"
 #endif
 
+#if defined(OKFFT_HAS_FMA) && !defined(OKFFT_HAS_AVX)
+    #error "FMA xforms share the AVX twiddle layout and leafs, enable avx xforms too!"
+#endif
+
+#if defined(OKFFT_HAS_AVX512) && !defined(OKFFT_HAS_FMA)
+    #error "AVX512 xforms reuse the FMA kernels for the small passes, enable fma xforms too!"
+#endif
+
 // overrides for custom memory allocation
 #ifndef OKFFT_CUSTOM_ALLOC
     
@@ -61,7 +71,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     #define OKFFT_FREE_DATA(ptr)        free(ptr)
     #define OKFFT_FREE_TEMP_DATA(ptr)   free(ptr)
 
-    #ifdef OKFFT_HAS_AVX
+    #if defined(OKFFT_HAS_AVX512)
+        #define OKFFT_ALLOC_ALIGNED_DATA(size) _mm_malloc(size, 64)
+    #elif defined(OKFFT_HAS_AVX)
         #define OKFFT_ALLOC_ALIGNED_DATA(size) _mm_malloc(size, 32)
     #else
         #define OKFFT_ALLOC_ALIGNED_DATA(size) _mm_malloc(size, 16)
@@ -75,6 +87,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     #define OKFFT_FREE_ALIGNED_DATA(ptr)        _mm_free(ptr)
     #define OKFFT_FREE_TEMP_ALIGNED_DATA(ptr)   OKFFT_FREE_ALIGNED_DATA(ptr)
     #define OKFFT_FREE_BUFFER(ptr)              OKFFT_FREE_ALIGNED_DATA(ptr)
+
+    // one block per plan holding the plan and all its tables, 'align' is 64 bytes or 2 MB (huge pages)
+    #define OKFFT_ALLOC_PLAN_ARENA(size, align) _mm_malloc(size, align)
+    #define OKFFT_FREE_PLAN_ARENA(ptr)          _mm_free(ptr)
 #endif
 
 #ifndef OKFFT_LOG
@@ -82,52 +98,314 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 struct okfft_plan_t;
+struct okfft_kernels_t;
+struct okfft_cache_entry_t;
+struct okfft_twiddles_t;
 typedef void (*okfft_xform_func_t)(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
+typedef void (*okfft_passes_func_t)(const okfft_plan_t *plan, float *__restrict data, size_t N);
+typedef void (*okfft_x8_func_t)(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end);
+typedef void (*okfft_split_func_t)(const okfft_plan_t *plan, float *__restrict out_re, float *__restrict out_im, const float *__restrict in_re, const float *__restrict in_im);
+
+// per thread scratch slots, the layout xforms (strided, ...) wrap the mixed radix / bluestein ones
+#define OKFFT_SCRATCH_XFORM     0
+#define OKFFT_SCRATCH_LAYOUT    1
+#define OKFFT_SCRATCH_ROWS      2
+#define OKFFT_SCRATCH_REAL      3
+#define OKFFT_SCRATCH_SLOTS     4
 
 struct okfft_plan_t
 {
     float *__restrict ws;               // twiddles
-    ptrdiff_t *__restrict offsets;      // output indices
+    uint32_t *__restrict offsets;       // output indices (in floats, hence N <= 2^31)
     
     ptrdiff_t is[8];                    // input indices
     ptrdiff_t *__restrict ws_is;        // twiddle factor indices
+    okfft_twiddles_t *twiddles;         // shared tables 'ws' and 'ws_is' point into
 
     size_t N;                           // transform size (used by the generic xform)
     size_t i0, i1;                      // base case loop sizes (used by the generic xform)
     
     okfft_xform_func_t xform;           // ptr to xform function
+    okfft_passes_func_t passes;         // combine passes only, power of two N >= 32 (used by the layout xforms)
+    okfft_x8_func_t x8;                 // slice of the last combine pass of 'passes' (used by the parallel xforms)
 
     float *__restrict A;                // coeffs for real valued xforms
     float *__restrict B;
 
+    const okfft_kernels_t *kernels;     // kernel set picked at plan creation (used by the real xforms)
+
+    // mixed radix xforms, N = P * M with P = 2^a and M = 3^b * 5^c
+    size_t M;
+    okfft_plan_t *sub;                  // power of two plan for the P point row xforms (NULL if P == 1)
+    float *__restrict mr_ws;            // twiddles for the radix 3 / 5 passes
+    float *__restrict mr_dit;           // W_N^(n2 * k1) for the M rows of P values
+    uint8_t radix[40];                  // radix of each pass, 5s first
+    size_t radix_count;
+
+    // bluestein xforms (any other N), 'sub' is the power of two convolution plan
+    float *__restrict chirp;            // w_n = exp(-i pi n^2 / N), conjugated for the inverse
+    float *__restrict chirp_ft;         // fft of the conjugate chirp, scaled by 1 / sub->N
+
+    // layout xforms, wrapping the unit stride 'xform_contig'
+    okfft_xform_func_t xform_contig;
+    size_t istride, ostride;            // in complex elements
+    okfft_split_func_t xform_split;     // separate re / im arrays (NULL if not a split plan)
+    okfft_xform_func_t xform_inv;       // inverse of a bidirectional plan (NULL if not one)
+    uint32_t *__restrict ip_cycles;     // in place leaf permutation, cycles of 64 byte lines as { length, lines... }
+    size_t ip_cycles_size;
+
+    // multi dimensional xforms, row major (N = dims[0] * ... * dims[rank - 1]), 'dim_plans[i]' runs along dimension i
+    size_t rank;
+    size_t dims[3];
+    okfft_plan_t *dim_plans[3];
+
+    // four step xforms, the 2d N2 x N1 view of N: W_N^m = lo[m & (2^shift - 1)] * hi[m >> shift], 'fs_ws' is lo then hi
+    float *__restrict fs_ws;
+    size_t fs_shift;
+
+    okfft_cache_entry_t *cache;         // shared plans from 'okfft_get_plan' (NULL for plans owned by the caller)
+
+    // the block the plan, its tables and its sub plans live in (NULL for the sub plans and under construction)
+    void *arena;
+    size_t arena_size;
+
     size_t flags;
 };
 
 struct okfft_buffer_t { float *buffer; };
 
+// double precision plans, the tables are the float ones computed and stored in double
+struct okfft_plan_d_t;
+typedef void (*okfft_xform_d_func_t)(const okfft_plan_d_t *plan, double *__restrict output, const double *__restrict input);
+
+struct okfft_plan_d_t
+{
+    double *__restrict ws;              // twiddles
+    uint32_t *__restrict offsets;       // output indices (in floats, hence N <= 2^31)
+    
+    ptrdiff_t is[8];                    // input indices
+    ptrdiff_t *__restrict ws_is;        // twiddle factor indices
+
+    size_t N;                           // transform size
+    size_t i0, i1;                      // base case loop sizes
+    
+    okfft_xform_d_func_t xform;         // ptr to xform function
+
+    double *__restrict A;               // coeffs for real valued xforms
+    double *__restrict B;
+
+    const okfft_kernels_t *kernels;     // kernel set picked at plan creation
+
+    void *arena;                        // the block the plan and its tables live in
+    size_t arena_size;
+
+    size_t flags;
+};
+
+struct okfft_buffer_d_t { double *buffer; };
+
 // 'okfft_buffer_t' is needed to keep the real transforms thread safe!
 okfft_buffer_t okfft_create_buffer(size_t N);
 void okfft_destroy_buffer(okfft_buffer_t *buffer);
 
+okfft_buffer_d_t okfft_create_buffer_d(size_t N);
+void okfft_destroy_buffer_d(okfft_buffer_d_t *buffer);
+
 enum OKFFT_DIRECTION
 {
     OKFFT_DIR_FORWARD,
     OKFFT_DIR_INVERSE
 };
 
+// kernel sets, the best one supported by the cpu and the OS is picked once at load
+// the 'OKFFT_ISA' environment variable (auto, sse, avx, fma or avx512) overrides the choice
+enum OKFFT_ISA
+{
+    OKFFT_ISA_AUTO,
+    OKFFT_ISA_SSE,
+    OKFFT_ISA_AVX,
+    OKFFT_ISA_FMA,
+    OKFFT_ISA_AVX512
+};
+
+// forces the kernel set for plans created after the call, 'OKFFT_ISA_AUTO' restores the cpu dispatch
+// returns false (and keeps the current set) if the set isn't compiled in or can't run on this machine
+// NOT thread safe with plan creation, existing plans keep the set they were created with
+bool okfft_set_isa(OKFFT_ISA isa);
+OKFFT_ISA okfft_get_isa();
+
 // complex -> complex
+// any N >= 2; 2^a * 3^b * 5^c sizes use mixed radix passes, all others Bluestein's algorithm around a power of two xform
+// the non power of two sizes use a per thread scratch buffer (kept until the thread exits)
 okfft_plan_t *okfft_create_plan(size_t N, OKFFT_DIRECTION dir);
 
+// complex -> complex with input / output element strides (in complex values, e.g. a matrix column or one channel)
+// the input gather is folded into the leaf pass for power of two N >= 32, anything else goes through a per thread scratch buffer
+okfft_plan_t *okfft_create_plan_strided(size_t N, OKFFT_DIRECTION dir, size_t istride, size_t ostride);
+
+// complex -> complex on split data (separate re / im arrays, run with 'okfft_execute_split'), any N >= 2
+// the leafs read the split input directly for power of two N >= 32, the output is split from a per thread scratch buffer
+// split plans run interleaved data through 'okfft_execute' too
+okfft_plan_t *okfft_create_plan_split(size_t N, OKFFT_DIRECTION dir);
+
+// complex -> complex in place, run with 'okfft_execute(plan, data, data)' (different buffers work too), any N >= 2
+// power of two N >= 128k permute the input in place before the leaf pass (the permutation table is about N / 2 bytes),
+// smaller sizes (and any non power of two) copy the input to a per thread scratch buffer
+okfft_plan_t *okfft_create_plan_inplace(size_t N, OKFFT_DIRECTION dir);
+
+// complex -> complex split across the worker threads ('okfft_set_threads'), any N >= 2, run with 'okfft_execute'
+// power of two N >= 128k run the leafs and the combine passes on all workers, anything else runs like a 'okfft_create_plan' plan
+okfft_plan_t *okfft_create_plan_parallel(size_t N, OKFFT_DIRECTION dir);
+
+// complex -> complex in both directions from one set of tables (the forward ones), any N >= 2, run with 'okfft_execute_dir'
+// ('okfft_execute' runs the forward xform). The inverse is the forward xform with the output reversed (X[k] <-> X[N - k]).
+okfft_plan_t *okfft_create_plan_bidir(size_t N);
+
+// complex -> complex for sizes past the last level cache, power of two N >= 2^18 (anything else gets a regular plan)
+// Bailey's four step algorithm on the N2 x N1 matrix view of the input (N1 = 2^floor(log2(N) / 2), N2 = N / N1):
+// N2 point column xforms, the W_N^(n1 * k2) multiply, N1 point row xforms and the transpose into the output,
+// all in cache blocked tiles. Uses a per thread scratch buffer of N complex values.
+okfft_plan_t *okfft_create_plan_fourstep(size_t N, OKFFT_DIRECTION dir);
+
+// 2d complex -> complex, 'rows' x 'cols' row major, both powers of two >= 2, run with 'okfft_execute'
+// rows are transformed in place in the output, columns in cache blocked tiles through a per thread scratch buffer
+okfft_plan_t *okfft_create_plan_2d(size_t rows, size_t cols, OKFFT_DIRECTION dir);
+
+// 3d complex -> complex, 'd0' x 'd1' x 'd2' row major (d2 contiguous), all powers of two >= 2, run with 'okfft_execute'
+// same scheme as 2d, the d1 pencils are the columns of each d0 slab, the d0 pencils the columns of d0 x (d1 * d2)
+okfft_plan_t *okfft_create_plan_3d(size_t d0, size_t d1, size_t d2, OKFFT_DIRECTION dir);
+
+// 2d real -> complex, 'rows' x 'cols' real values to the rows x (cols / 2 + 1) half spectrum (and back for the inverse),
+// rows a power of two >= 2, cols >= 4, run with 'okfft_execute'. Real row xforms, complex xforms over the half spectrum columns.
+// The inverse works on a padded copy of the spectrum in a per thread scratch buffer, 'input' is left alone.
+okfft_plan_t *okfft_create_plan_real_2d(size_t rows, size_t cols, OKFFT_DIRECTION dir);
+
 // real -> complex
+// N must be a power of two >= 4, sizes up to 32 use unrolled kernels which don't touch the state buffer
 okfft_plan_t *okfft_create_plan_real(size_t N, OKFFT_DIRECTION dir);
 
+// frees the plan with all its tables
 void okfft_destroy_plan(okfft_plan_t *plan);
 
+// an independent copy of the plan (one allocation and a copy per table), NULL if out of memory
+okfft_plan_t *okfft_copy_plan(const okfft_plan_t *plan);
+
+// the plan constructors 'okfft_get_plan' can share
+enum OKFFT_PLAN_KIND
+{
+    OKFFT_KIND_COMPLEX,     // okfft_create_plan
+    OKFFT_KIND_REAL,        // okfft_create_plan_real
+    OKFFT_KIND_SPLIT,       // okfft_create_plan_split
+    OKFFT_KIND_INPLACE,     // okfft_create_plan_inplace
+    OKFFT_KIND_PARALLEL,    // okfft_create_plan_parallel
+    OKFFT_KIND_FOURSTEP,    // okfft_create_plan_fourstep
+    OKFFT_KIND_BIDIR        // okfft_create_plan_bidir (one plan for both directions, 'dir' is ignored)
+};
+
+// a plan shared through a process wide cache keyed by N, direction, kind and the current kernel set ('okfft_get_isa'),
+// created by the first call for a key and reference counted, NULL if the constructor fails. Thread safe: lookups are
+// lock free, a miss creates the plan under the lock of its hash bucket so other keys aren't held up.
+// Every plan returned has to be handed back with 'okfft_release_plan' (never 'okfft_destroy_plan').
+const okfft_plan_t *okfft_get_plan(size_t N, OKFFT_DIRECTION dir, OKFFT_PLAN_KIND kind);
+void okfft_release_plan(const okfft_plan_t *plan);
+
+// drops the cache's own references, plans are freed once their last user releases them
+// NOT thread safe with 'okfft_get_plan'
+void okfft_clear_plan_cache();
+
+// wisdom files: the leaf offsets and shared twiddles of the cached plans of the current kernel set (and their keys),
+// in a versioned binary format tagged with the kernel set. The file is written next to 'path' and renamed over it.
+bool okfft_export_plans(const char *path);
+
+// maps a file of 'okfft_export_plans' read only (POSIX only) and puts the plans it lists in the cache, plans created
+// afterwards use its tables in place instead of computing them. The file stays mapped until the process exits.
+// Returns false (logged) if it is from another version, build or kernel set.
+bool okfft_import_plans(const char *path);
+
+// worker threads used by the parallel plans, including the calling thread (0 = one per hardware thread, the default)
+// the workers are started on first use and shared by all parallel plans and batches, NOT thread safe with running parallel xforms
+void okfft_set_threads(size_t threads);
+size_t okfft_get_threads();
+
+// pins worker i of the pool to logical cpu i (worker 0 is the calling thread, it is left alone), takes effect when
+// the workers start (the first parallel call after 'okfft_set_threads'), not supported on every OS
+void okfft_set_thread_affinity(bool pin);
+
+// a user supplied thread pool for the parallel batches: 'submit' runs 'task(task_ctx)' on any thread (or right away),
+// 'wait' returns once every task submitted so far has returned. A batch is split into 'threads' tasks.
+struct okfft_executor_t
+{
+    void *ctx;
+    size_t threads;                     // tasks per batch (at most one per transform), 0 = one per hardware thread
+    void (*submit)(void *ctx, void (*task)(void *task_ctx), void *task_ctx);
+    void (*wait)(void *ctx);
+};
+
 // for complex -> complex transforms
 // thread safe for plan
 void okfft_execute(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input);
 
+// for bidirectional plans ('okfft_create_plan_bidir'), same rules as 'okfft_execute'
+void okfft_execute_dir(const okfft_plan_t *plan, OKFFT_DIRECTION dir, float *__restrict output, const float *__restrict input);
+
+// for complex -> complex transforms on split data, 'plan' must come from 'okfft_create_plan_split'
+// no alignment requirements, thread safe for plan
+void okfft_execute_split(const okfft_plan_t *plan, float *__restrict out_re, float *__restrict out_im, const float *__restrict in_re, const float *__restrict in_im);
+
 // for real -> complex / complex -> real transforms
 // thread safe for plan (not state buffer!)
 // NOTE: due to how this optimisation works, the complex -> real xform reads *N + 2* elements from 'input'. Easiest way to ensure the required capacity is to use a 'okfft_buffer_t'
 void okfft_execute_real(const okfft_plan_t *plan, okfft_buffer_t *state, float *__restrict output, const float *__restrict input);
+
+// 'howmany' transforms, the i-th one reads 'input + i * idist' and writes 'output + i * odist' (distances in floats)
+// every input / output has to meet the alignment rules of the single transform calls, the next input is prefetched during the current transform
+// thread safe for plan (not state buffer!)
+void okfft_execute_batch(const okfft_plan_t *plan, size_t howmany, const float *input, ptrdiff_t idist, float *output, ptrdiff_t odist);
+void okfft_execute_real_batch(const okfft_plan_t *plan, okfft_buffer_t *state, size_t howmany, const float *input, ptrdiff_t idist, float *output, ptrdiff_t odist);
+
+// the batches above split across the threads of 'executor' (NULL = the pool of 'okfft_set_threads'), threads take
+// runs of transforms as they get free. The real version keeps a state buffer per thread (kept until the thread exits).
+void okfft_execute_batch_parallel(const okfft_plan_t *plan, size_t howmany, const float *input, ptrdiff_t idist, float *output, ptrdiff_t odist, const okfft_executor_t *executor);
+void okfft_execute_real_batch_parallel(const okfft_plan_t *plan, size_t howmany, const float *input, ptrdiff_t idist, float *output, ptrdiff_t odist, const okfft_executor_t *executor);
+
+// throughput of one pass of an out of core xform, 'bytes' read plus written, GFLOPS by the 5 N log2(N) model
+struct okfft_ooc_pass_t
+{
+    size_t bytes;
+    double io_seconds;      // gathers, writes and readahead hints, including page faults
+    double compute_seconds; // xforms and twiddles in the working buffer
+    double io_mb_per_s;
+    double gflops;
+};
+
+struct okfft_ooc_stats_t
+{
+    okfft_ooc_pass_t pass[2];
+};
+
+// out of core complex -> complex for data larger than ram, 'plan' must come from 'okfft_create_plan_fourstep' (N >= 2^18)
+// two passes over memory, each streaming blocks of whole columns through a working buffer of 'buffer_bytes'
+// (at least 16 * sqrt(2N) bytes, more means longer runs per row), 'output' is used as the intermediate.
+// 'input' and 'output' may be mapped files, no alignment requirements, 'stats' may be NULL. Returns false on errors (logged).
+bool okfft_execute_ooc(const okfft_plan_t *plan, float *output, const float *input, size_t buffer_bytes, okfft_ooc_stats_t *stats);
+
+// the same between files of N complex values (POSIX only): the input is mapped read only, the output is created
+// (or truncated) and the time to flush it is part of the last pass. The paths must name different files, the same file
+// (also through a link) is refused before anything is truncated.
+bool okfft_execute_ooc_file(const okfft_plan_t *plan, const char *output_path, const char *input_path, size_t buffer_bytes, okfft_ooc_stats_t *stats);
+
+// double precision versions of the 1d plans above, same layouts and thread safety rules, but powers of two only
+// input and output must be aligned like 'OKFFT_ALLOC_ALIGNED_DATA' (the AVX kernels use 32 byte aligned stores)
+
+// complex -> complex, N a power of two from 2 to 2^31 (no mixed radix or Bluestein sizes), NULL otherwise
+okfft_plan_d_t *okfft_create_plan_d(size_t N, OKFFT_DIRECTION dir);
+
+// real -> complex, N a power of two from 64 (the float version goes down to 4), NULL otherwise
+okfft_plan_d_t *okfft_create_plan_real_d(size_t N, OKFFT_DIRECTION dir);
+
+void okfft_destroy_plan_d(okfft_plan_d_t *plan);
+
+void okfft_execute_d(const okfft_plan_d_t *plan, double *__restrict output, const double *__restrict input);
+
+// NOTE: like 'okfft_execute_real', the complex -> real xform reads *N + 2* elements from 'input'
+void okfft_execute_real_d(const okfft_plan_d_t *plan, okfft_buffer_d_t *state, double *__restrict output, const double *__restrict input);
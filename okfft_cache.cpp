@@ -0,0 +1,197 @@
+/*
+This file is part of OKFFT
+
+BSD 3-Clause License
+
+Copyright (c) 2012, 2013, Anthony M. Blake <amb@anthonix.com>
+Copyright (c) 2012, The University of Waikato
+Copyright (c) 2015, Jukka Ojanen <jukka.ojanen@kolumbus.fi>
+Copyright (c) 2017, Espen Andreassen <espandre@gmail.com>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+* Neither the name of the organization nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ANTHONY M. BLAKE BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "okfft.h"
+
+#include <stdio.h> // for printf (default log)
+#include <mutex>
+#include <atomic>
+
+// Process wide plan cache. Entries are never unlinked while the cache is in use, so a lookup is a walk over an
+// immutable list per hash bucket: the only writes are the publishing store of a new list head (under the bucket's
+// lock, after the entry is complete) and the reference count. The cache keeps one reference of its own, which
+// 'okfft_clear_plan_cache' drops.
+
+#define OKFFT_CACHE_BUCKETS 64
+
+struct okfft_cache_entry_t
+{
+    size_t N;
+    OKFFT_DIRECTION dir;
+    OKFFT_PLAN_KIND kind;
+    OKFFT_ISA isa;
+
+    okfft_plan_t *plan;
+    std::atomic<size_t> refs;
+    okfft_cache_entry_t *next;
+};
+
+struct okfft_cache_bucket_t
+{
+    std::atomic<okfft_cache_entry_t *> head;
+    std::mutex lock;
+};
+
+static okfft_cache_bucket_t okfft_cache[OKFFT_CACHE_BUCKETS];
+
+static size_t okfft_cache_hash(size_t N, OKFFT_DIRECTION dir, OKFFT_PLAN_KIND kind, OKFFT_ISA isa)
+{
+    uint64_t h = ((uint64_t) N << 8) ^ ((uint64_t) kind << 4) ^ ((uint64_t) isa << 1) ^ (uint64_t) dir;
+    return (size_t) ((h * 0x9E3779B97F4A7C15ull) >> 58); // top 6 bits, 64 buckets
+}
+
+static okfft_cache_entry_t *okfft_cache_find(okfft_cache_entry_t *e, size_t N, OKFFT_DIRECTION dir, OKFFT_PLAN_KIND kind, OKFFT_ISA isa)
+{
+    for (; e; e = e->next)
+    {
+        if (e->N == N && e->dir == dir && e->kind == kind && e->isa == isa)
+            return e;
+    }
+
+    return NULL;
+}
+
+static okfft_plan_t *okfft_cache_create(size_t N, OKFFT_DIRECTION dir, OKFFT_PLAN_KIND kind)
+{
+    switch (kind)
+    {
+        case OKFFT_KIND_COMPLEX:  return okfft_create_plan(N, dir);
+        case OKFFT_KIND_REAL:     return okfft_create_plan_real(N, dir);
+        case OKFFT_KIND_SPLIT:    return okfft_create_plan_split(N, dir);
+        case OKFFT_KIND_INPLACE:  return okfft_create_plan_inplace(N, dir);
+        case OKFFT_KIND_PARALLEL: return okfft_create_plan_parallel(N, dir);
+        case OKFFT_KIND_FOURSTEP: return okfft_create_plan_fourstep(N, dir);
+        case OKFFT_KIND_BIDIR:    return okfft_create_plan_bidir(N);
+    }
+
+    OKFFT_LOG("Unknown plan kind %d.\n", (int) kind);
+    return NULL;
+}
+
+static void okfft_cache_unref(okfft_cache_entry_t *e)
+{
+    if (e->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    okfft_destroy_plan(e->plan);
+    delete e;
+}
+
+const okfft_plan_t *okfft_get_plan(size_t N, OKFFT_DIRECTION dir, OKFFT_PLAN_KIND kind)
+{
+    if (kind == OKFFT_KIND_BIDIR)
+        dir = OKFFT_DIR_FORWARD;
+
+    const OKFFT_ISA isa = okfft_get_isa();
+    okfft_cache_bucket_t &bucket = okfft_cache[okfft_cache_hash(N, dir, kind, isa)];
+
+    okfft_cache_entry_t *e = okfft_cache_find(bucket.head.load(std::memory_order_acquire), N, dir, kind, isa);
+
+    if (!e)
+    {
+        std::lock_guard<std::mutex> lock(bucket.lock);
+
+        // another thread may have created it while this one waited
+        e = okfft_cache_find(bucket.head.load(std::memory_order_relaxed), N, dir, kind, isa);
+
+        if (!e)
+        {
+            okfft_plan_t *plan = okfft_cache_create(N, dir, kind);
+            if (!plan)
+                return NULL;
+
+            e = new okfft_cache_entry_t;
+            e->N = N;
+            e->dir = dir;
+            e->kind = kind;
+            e->isa = isa;
+            e->plan = plan;
+            e->refs.store(1, std::memory_order_relaxed); // the cache's own
+            e->next = bucket.head.load(std::memory_order_relaxed);
+            plan->cache = e;
+
+            bucket.head.store(e, std::memory_order_release);
+        }
+    }
+
+    e->refs.fetch_add(1, std::memory_order_relaxed);
+    return e->plan;
+}
+
+void okfft_release_plan(const okfft_plan_t *plan)
+{
+    if (plan && plan->cache)
+        okfft_cache_unref(plan->cache);
+}
+
+void okfft_clear_plan_cache()
+{
+    for (size_t i = 0; i < OKFFT_CACHE_BUCKETS; i++)
+    {
+        std::lock_guard<std::mutex> lock(okfft_cache[i].lock);
+
+        okfft_cache_entry_t *e = okfft_cache[i].head.exchange(NULL, std::memory_order_acq_rel);
+        while (e)
+        {
+            okfft_cache_entry_t *next = e->next;
+            okfft_cache_unref(e);
+            e = next;
+        }
+    }
+}
+
+// calls 'fn' for every cached plan of the current kernel set, under the lock of its bucket (for 'okfft_export_plans')
+// with one more reference on the plan, which the caller hands back with 'okfft_release_plan'
+void okfft_cache_for_each(void (*fn)(void *ctx, const okfft_plan_t *plan, size_t N, OKFFT_DIRECTION dir, OKFFT_PLAN_KIND kind), void *ctx)
+{
+    const OKFFT_ISA isa = okfft_get_isa();
+
+    for (size_t i = 0; i < OKFFT_CACHE_BUCKETS; i++)
+    {
+        std::lock_guard<std::mutex> lock(okfft_cache[i].lock);
+
+        for (okfft_cache_entry_t *e = okfft_cache[i].head.load(std::memory_order_acquire); e; e = e->next)
+        {
+            if (e->isa != isa)
+                continue;
+
+            e->refs.fetch_add(1, std::memory_order_relaxed);
+            fn(ctx, e->plan, e->N, e->dir, e->kind);
+        }
+    }
+}
@@ -47,6 +47,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define okfft_sse_unpack_hi(x, y) _mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 2, 3, 2))
 #define okfft_sse_blend(x, y)     _mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 2, 1, 0))
 
+// leaf input loads (two complex values), overridden by the strided leaf passes
+#ifndef okfft_sse_load_leaf
+    #define okfft_sse_load_leaf(p)    _mm_load_ps(p)
+#endif
+
 #define okfft_sse_store4(base, r0, r1, r2, r3)              \
 {                                                           \
     _mm_store_ps(base +  0, r0);                            \
@@ -158,20 +163,21 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     _mm_store_ps(data + 12, r11);                           \
 }
 
-#define OKFFT_SSE_X8(N, data, p_lut)                        \
+// radix 8 combine pass over N values, '_PART' does floats [begin, end) of each of the 8 streams (multiples of 4)
+#define OKFFT_SSE_X8_PART(N, data, p_lut, begin, end)       \
 {                                                           \
     size_t OFFS = N >> 2;                                   \
-    const float *__restrict lut = (p_lut);                  \
-    float *__restrict d0 = data + (0 * OFFS);               \
-    float *__restrict d1 = data + (1 * OFFS);               \
-    float *__restrict d2 = data + (2 * OFFS);               \
-    float *__restrict d3 = data + (3 * OFFS);               \
-    float *__restrict d4 = data + (4 * OFFS);               \
-    float *__restrict d5 = data + (5 * OFFS);               \
-    float *__restrict d6 = data + (6 * OFFS);               \
-    float *__restrict d7 = data + (7 * OFFS);               \
-                                                            \
-    for (size_t i = 0; i < (N >> 4); i++)                   \
+    const float *__restrict lut = (p_lut) + 6 * (begin);    \
+    float *__restrict d0 = data + (0 * OFFS) + (begin);     \
+    float *__restrict d1 = data + (1 * OFFS) + (begin);     \
+    float *__restrict d2 = data + (2 * OFFS) + (begin);     \
+    float *__restrict d3 = data + (3 * OFFS) + (begin);     \
+    float *__restrict d4 = data + (4 * OFFS) + (begin);     \
+    float *__restrict d5 = data + (5 * OFFS) + (begin);     \
+    float *__restrict d6 = data + (6 * OFFS) + (begin);     \
+    float *__restrict d7 = data + (7 * OFFS) + (begin);     \
+                                                            \
+    for (size_t i = (begin); i < (end); i += 4)             \
     {                                                       \
         __m128 r0 = _mm_load_ps(d0);                        \
         __m128 r1 = _mm_load_ps(d1);                        \
@@ -210,6 +216,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     }                                                       \
 }
 
+#define OKFFT_SSE_X8(N, data, p_lut) OKFFT_SSE_X8_PART(N, data, p_lut, 0, (N) / 4)
+
 #define OKFFT_SSE_TX2(a, b)                                 \
 {                                                           \
     __m128 q0 = okfft_sse_unpack_lo(a, b);                  \
@@ -220,10 +228,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define OKFFT_SSE_L2(i0, i1, i2, i3, r0, r1, r2, r3)        \
 {                                                           \
-    __m128 t0 = _mm_load_ps(i0);                            \
-    __m128 t1 = _mm_load_ps(i1);                            \
-    __m128 t2 = _mm_load_ps(i2);                            \
-    __m128 t3 = _mm_load_ps(i3);                            \
+    __m128 t0 = okfft_sse_load_leaf(i0);                    \
+    __m128 t1 = okfft_sse_load_leaf(i1);                    \
+    __m128 t2 = okfft_sse_load_leaf(i2);                    \
+    __m128 t3 = okfft_sse_load_leaf(i3);                    \
                                                             \
     r0 = _mm_add_ps(t0, t1);                                \
     r1 = _mm_sub_ps(t0, t1);                                \
@@ -233,10 +241,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define OKFFT_SSE_L4(i0, i1, i2, i3, r0, r1, r2, r3)        \
 {                                                           \
-    __m128 t0 = _mm_load_ps(i0);                            \
-    __m128 t1 = _mm_load_ps(i1);                            \
-    __m128 t2 = _mm_load_ps(i2);                            \
-    __m128 t3 = _mm_load_ps(i3);                            \
+    __m128 t0 = okfft_sse_load_leaf(i0);                    \
+    __m128 t1 = okfft_sse_load_leaf(i1);                    \
+    __m128 t2 = okfft_sse_load_leaf(i2);                    \
+    __m128 t3 = okfft_sse_load_leaf(i3);                    \
                                                             \
     __m128 t4 = _mm_add_ps(t0, t1);                         \
     __m128 t5 = _mm_sub_ps(t0, t1);                         \
@@ -254,10 +262,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define OKFFT_SSE_L44(i0, i1, i2, i3, r0, r1, r2, r3)       \
 {                                                           \
-    __m128 t0 = _mm_load_ps(i0);                            \
-    __m128 t1 = _mm_load_ps(i1);                            \
-    __m128 t2 = _mm_load_ps(i2);                            \
-    __m128 t3 = _mm_load_ps(i3);                            \
+    __m128 t0 = okfft_sse_load_leaf(i0);                    \
+    __m128 t1 = okfft_sse_load_leaf(i1);                    \
+    __m128 t2 = okfft_sse_load_leaf(i2);                    \
+    __m128 t3 = okfft_sse_load_leaf(i3);                    \
                                                             \
     __m128 t4 = _mm_add_ps(t0, t1);                         \
     __m128 t5 = _mm_sub_ps(t0, t1);                         \
@@ -283,10 +291,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define OKFFT_SSE_L42(i0, i1, i2, i3, r0, r1, r2, r3)       \
 {                                                           \
-    __m128 t0 = _mm_load_ps(i0);                            \
-    __m128 t1 = _mm_load_ps(i1);                            \
-    __m128 t6 = _mm_load_ps(i2);                            \
-    __m128 t7 = _mm_load_ps(i3);                            \
+    __m128 t0 = okfft_sse_load_leaf(i0);                    \
+    __m128 t1 = okfft_sse_load_leaf(i1);                    \
+    __m128 t6 = okfft_sse_load_leaf(i2);                    \
+    __m128 t7 = okfft_sse_load_leaf(i3);                    \
                                                             \
     __m128 t2 = okfft_sse_blend(t6, t7);                    \
     __m128 t3 = okfft_sse_blend(t7, t6);                    \
@@ -313,10 +321,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define OKFFT_SSE_L24(i0, i1, i2, i3, r0, r1, r2, r3)       \
 {                                                           \
-    __m128 t0 = _mm_load_ps(i0);                            \
-    __m128 t1 = _mm_load_ps(i1);                            \
-    __m128 t2 = _mm_load_ps(i2);                            \
-    __m128 t3 = _mm_load_ps(i3);                            \
+    __m128 t0 = okfft_sse_load_leaf(i0);                    \
+    __m128 t1 = okfft_sse_load_leaf(i1);                    \
+    __m128 t2 = okfft_sse_load_leaf(i2);                    \
+    __m128 t3 = okfft_sse_load_leaf(i3);                    \
                                                             \
     __m128 t4 = _mm_add_ps(t0, t1);                         \
     __m128 t5 = _mm_sub_ps(t0, t1);                         \
@@ -458,7 +466,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     float *__restrict out = p_out;                          \
     const float *__restrict in = p_in;                      \
     const ptrdiff_t *__restrict is = p->is;                 \
-    const ptrdiff_t *__restrict os = p->offsets;            \
+    const uint32_t *__restrict os = p->offsets;             \
                                                             \
     for (size_t i = i0; i > 0; --i)                         \
     {                                                       \
@@ -491,7 +499,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     float *__restrict out = p_out;                          \
     const float *__restrict in = p_in;                      \
     const ptrdiff_t *__restrict is = p->is;                 \
-    const ptrdiff_t *__restrict os = p->offsets;            \
+    const uint32_t *__restrict os = p->offsets;             \
                                                             \
     for (size_t i = i0; i > 0; --i)                         \
     {                                                       \
@@ -713,20 +721,21 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     _mm256_store_ps(data + 56, r31);                        \
 }
 
-#define OKFFT_AVX_X8(N, data, p_lut)                        \
+// radix 8 combine pass over N values, '_PART' does floats [begin, end) of each of the 8 streams (multiples of 8)
+#define OKFFT_AVX_X8_PART(N, data, p_lut, begin, end)       \
 {                                                           \
     const size_t OFFS = N / 4;                              \
-    const float *__restrict lut = (p_lut);                  \
-    float *__restrict d0 = data + (0 * OFFS);               \
-    float *__restrict d1 = data + (1 * OFFS);               \
-    float *__restrict d2 = data + (2 * OFFS);               \
-    float *__restrict d3 = data + (3 * OFFS);               \
-    float *__restrict d4 = data + (4 * OFFS);               \
-    float *__restrict d5 = data + (5 * OFFS);               \
-    float *__restrict d6 = data + (6 * OFFS);               \
-    float *__restrict d7 = data + (7 * OFFS);               \
-                                                            \
-    for (size_t i = 0; i < N / 32; i++)                     \
+    const float *__restrict lut = (p_lut) + 6 * (begin);    \
+    float *__restrict d0 = data + (0 * OFFS) + (begin);     \
+    float *__restrict d1 = data + (1 * OFFS) + (begin);     \
+    float *__restrict d2 = data + (2 * OFFS) + (begin);     \
+    float *__restrict d3 = data + (3 * OFFS) + (begin);     \
+    float *__restrict d4 = data + (4 * OFFS) + (begin);     \
+    float *__restrict d5 = data + (5 * OFFS) + (begin);     \
+    float *__restrict d6 = data + (6 * OFFS) + (begin);     \
+    float *__restrict d7 = data + (7 * OFFS) + (begin);     \
+                                                            \
+    for (size_t i = (begin); i < (end); i += 8)             \
     {                                                       \
         __m256 re = _mm256_load_ps(lut +  0);               \
         __m256 im = _mm256_load_ps(lut +  8);               \
@@ -763,6 +772,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     }                                                       \
 }
 
+#define OKFFT_AVX_X8(N, data, p_lut) OKFFT_AVX_X8_PART(N, data, p_lut, 0, (N) / 4)
+
 #define OKFFT_AVX_X8_32(data, p_lut)                        \
 {                                                           \
     const float *__restrict lut = (p_lut);                  \
@@ -806,10 +817,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define OKFFT_AVX_L2(i0, i1, i2, i3, r0, r1, r2, r3)    \
 {                                                       \
-    __m256 t0 = _mm256_load_ps(i0);                     \
-    __m256 t1 = _mm256_load_ps(i1);                     \
-    __m256 t2 = _mm256_load_ps(i2);                     \
-    __m256 t3 = _mm256_load_ps(i3);                     \
+    __m256 t0 = _mm256_loadu_ps(i0);                    \
+    __m256 t1 = _mm256_loadu_ps(i1);                    \
+    __m256 t2 = _mm256_loadu_ps(i2);                    \
+    __m256 t3 = _mm256_loadu_ps(i3);                    \
                                                         \
     r0 = _mm256_add_ps(t0, t1);                         \
     r1 = _mm256_sub_ps(t0, t1);                         \
@@ -819,10 +830,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define OKFFT_AVX_L4(i0, i1, i2, i3, r0, r1, r2, r3)    \
 {                                                       \
-    __m256 t0 = _mm256_load_ps(i0);                     \
-    __m256 t1 = _mm256_load_ps(i1);                     \
-    __m256 t2 = _mm256_load_ps(i2);                     \
-    __m256 t3 = _mm256_load_ps(i3);                     \
+    __m256 t0 = _mm256_loadu_ps(i0);                    \
+    __m256 t1 = _mm256_loadu_ps(i1);                    \
+    __m256 t2 = _mm256_loadu_ps(i2);                    \
+    __m256 t3 = _mm256_loadu_ps(i3);                    \
                                                         \
     __m256 t4 = _mm256_add_ps(t0, t1);                  \
     __m256 t5 = _mm256_sub_ps(t0, t1);                  \
@@ -840,10 +851,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define OKFFT_AVX_L44(i0, i1, i2, i3, r0, r1, r2, r3)   \
 {                                                       \
-    __m256 t0 = _mm256_load_ps(i0);                     \
-    __m256 t1 = _mm256_load_ps(i1);                     \
-    __m256 t2 = _mm256_load_ps(i2);                     \
-    __m256 t3 = _mm256_load_ps(i3);                     \
+    __m256 t0 = _mm256_loadu_ps(i0);                    \
+    __m256 t1 = _mm256_loadu_ps(i1);                    \
+    __m256 t2 = _mm256_loadu_ps(i2);                    \
+    __m256 t3 = _mm256_loadu_ps(i3);                    \
                                                         \
     __m256 t4 = _mm256_add_ps(t0, t1);                  \
     __m256 t5 = _mm256_sub_ps(t0, t1);                  \
@@ -956,7 +967,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     float *__restrict out = p_out;                      \
     const float *__restrict in = p_in;                  \
     const ptrdiff_t *__restrict is = p->is;             \
-    const ptrdiff_t *__restrict os = p->offsets;        \
+    const uint32_t *__restrict os = p->offsets;         \
                                                         \
     for (size_t i = i0 >> 1; i > 0; --i)                \
     {                                                   \
@@ -993,7 +1004,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     float *__restrict out = p_out;                      \
     const float *__restrict in = p_in;                  \
     const ptrdiff_t *__restrict is = p->is;             \
-    const ptrdiff_t *__restrict os = p->offsets;        \
+    const uint32_t *__restrict os = p->offsets;         \
                                                         \
     for (size_t i = i0 >> 1; i > 0; --i)                \
     {                                                   \
@@ -1075,4 +1086,831 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     OKFFT_AVX_X8(1024, data, ws + (ws_is[6] << 1)); \
 }
 
-#endif
\ No newline at end of file
+#endif
+
+#ifdef OKFFT_HAS_FMA
+
+// FMA3 variants of the AVX butterflies. Only the macros that multiply by twiddles differ,
+// the twiddle and leaf layouts are shared with the AVX kernels.
+
+#define OKFFT_FMA_KN(re, im, r0, r1, r2, r3)                \
+{                                                           \
+    __m256 uk = r0, uk2 = r1;                               \
+    __m256 r2r = _mm256_mul_ps(re, r2);                     \
+    __m256 r3r = _mm256_mul_ps(re, r3);                     \
+                                                            \
+    r2 = okfft_avx_swap_pairs(r2);                          \
+    r3 = okfft_avx_swap_pairs(r3);                          \
+                                                            \
+    __m256 zk_p = _mm256_fnmadd_ps(im, r2, r2r);            \
+    __m256 zk_n = _mm256_fmadd_ps(im, r3, r3r);             \
+                                                            \
+    __m256 zk   = _mm256_add_ps(zk_p, zk_n);                \
+    __m256 zk_d = _mm256_sub_ps(zk_p, zk_n);                \
+                                                            \
+    r2 = _mm256_sub_ps(uk, zk);                             \
+    r0 = _mm256_add_ps(uk, zk);                             \
+                                                            \
+    zk_d = okfft_avx_swap_sign(zk_d);                       \
+    zk_d = okfft_avx_swap_pairs(zk_d);                      \
+                                                            \
+    r3 = _mm256_add_ps(uk2, zk_d);                          \
+    r1 = _mm256_sub_ps(uk2, zk_d);                          \
+}
+
+#define OKFFT_FMA_KNKN(re0, im0, re1, im1, r00, r10, r20, r30, r01, r11, r21, r31)  \
+{                                                       \
+    __m256 uk0  = r00, uk20 = r10;                      \
+    __m256 uk1  = r01, uk21 = r11;                      \
+    __m256 r20r = _mm256_mul_ps(re0, r20);              \
+    __m256 r21r = _mm256_mul_ps(re1, r21);              \
+    __m256 r30r = _mm256_mul_ps(re0, r30);              \
+    __m256 r31r = _mm256_mul_ps(re1, r31);              \
+                                                        \
+    r20 = okfft_avx_swap_pairs(r20);                    \
+    r21 = okfft_avx_swap_pairs(r21);                    \
+    r30 = okfft_avx_swap_pairs(r30);                    \
+    r31 = okfft_avx_swap_pairs(r31);                    \
+                                                        \
+    __m256 zk_p0 = _mm256_fnmadd_ps(im0, r20, r20r);    \
+    __m256 zk_p1 = _mm256_fnmadd_ps(im1, r21, r21r);    \
+    __m256 zk_n0 = _mm256_fmadd_ps(im0, r30, r30r);     \
+    __m256 zk_n1 = _mm256_fmadd_ps(im1, r31, r31r);     \
+                                                        \
+    __m256 zk0   = _mm256_add_ps(zk_p0, zk_n0);         \
+    __m256 zk1   = _mm256_add_ps(zk_p1, zk_n1);         \
+    __m256 zk_d0 = _mm256_sub_ps(zk_p0, zk_n0);         \
+    __m256 zk_d1 = _mm256_sub_ps(zk_p1, zk_n1);         \
+                                                        \
+    r20 = _mm256_sub_ps(uk0, zk0);                      \
+    r21 = _mm256_sub_ps(uk1, zk1);                      \
+    r00 = _mm256_add_ps(uk0, zk0);                      \
+    r01 = _mm256_add_ps(uk1, zk1);                      \
+                                                        \
+    zk_d0 = okfft_avx_swap_sign(zk_d0);                 \
+    zk_d1 = okfft_avx_swap_sign(zk_d1);                 \
+    zk_d0 = okfft_avx_swap_pairs(zk_d0);                \
+    zk_d1 = okfft_avx_swap_pairs(zk_d1);                \
+                                                        \
+    r30 = _mm256_add_ps(uk20, zk_d0);                   \
+    r31 = _mm256_add_ps(uk21, zk_d1);                   \
+    r10 = _mm256_sub_ps(uk20, zk_d0);                   \
+    r11 = _mm256_sub_ps(uk21, zk_d1);                   \
+}
+
+#define OKFFT_FMA_X4(data, lut)                             \
+{                                                           \
+    __m256 re = _mm256_load_ps(lut + 0);                    \
+    __m256 im = _mm256_load_ps(lut + 8);                    \
+                                                            \
+    __m256 r0 = _mm256_load_ps(data +  0);                  \
+    __m256 r1 = _mm256_load_ps(data +  8);                  \
+    __m256 r2 = _mm256_load_ps(data + 16);                  \
+    __m256 r3 = _mm256_load_ps(data + 24);                  \
+                                                            \
+    OKFFT_FMA_KN(re, im, r0, r1, r2, r3);                   \
+                                                            \
+    _mm256_store_ps(data +  0, r0);                         \
+    _mm256_store_ps(data +  8, r1);                         \
+    _mm256_store_ps(data + 16, r2);                         \
+    _mm256_store_ps(data + 24, r3);                         \
+}
+
+#define OKFFT_FMA_X4X4(data, lut)                           \
+{                                                           \
+    __m256 re = _mm256_load_ps(lut + 0);                    \
+    __m256 im = _mm256_load_ps(lut + 8);                    \
+                                                            \
+    __m256 r00 = _mm256_load_ps(data +  0);                 \
+    __m256 r10 = _mm256_load_ps(data +  8);                 \
+    __m256 r20 = _mm256_load_ps(data + 16);                 \
+    __m256 r30 = _mm256_load_ps(data + 24);                 \
+    __m256 r01 = _mm256_load_ps(data + 32);                 \
+    __m256 r11 = _mm256_load_ps(data + 40);                 \
+    __m256 r21 = _mm256_load_ps(data + 48);                 \
+    __m256 r31 = _mm256_load_ps(data + 56);                 \
+                                                            \
+    OKFFT_FMA_KNKN(re, im, re, im,  r00, r10, r20, r30,     \
+                                    r01, r11, r21, r31);    \
+                                                            \
+    _mm256_store_ps(data +  0, r00);                        \
+    _mm256_store_ps(data +  8, r10);                        \
+    _mm256_store_ps(data + 16, r20);                        \
+    _mm256_store_ps(data + 24, r30);                        \
+    _mm256_store_ps(data + 32, r01);                        \
+    _mm256_store_ps(data + 40, r11);                        \
+    _mm256_store_ps(data + 48, r21);                        \
+    _mm256_store_ps(data + 56, r31);                        \
+}
+
+// radix 8 combine pass over N values, '_PART' does floats [begin, end) of each of the 8 streams (multiples of 8)
+#define OKFFT_FMA_X8_PART(N, data, p_lut, begin, end)       \
+{                                                           \
+    const size_t OFFS = N / 4;                              \
+    const float *__restrict lut = (p_lut) + 6 * (begin);    \
+    float *__restrict d0 = data + (0 * OFFS) + (begin);     \
+    float *__restrict d1 = data + (1 * OFFS) + (begin);     \
+    float *__restrict d2 = data + (2 * OFFS) + (begin);     \
+    float *__restrict d3 = data + (3 * OFFS) + (begin);     \
+    float *__restrict d4 = data + (4 * OFFS) + (begin);     \
+    float *__restrict d5 = data + (5 * OFFS) + (begin);     \
+    float *__restrict d6 = data + (6 * OFFS) + (begin);     \
+    float *__restrict d7 = data + (7 * OFFS) + (begin);     \
+                                                            \
+    for (size_t i = (begin); i < (end); i += 8)             \
+    {                                                       \
+        __m256 re = _mm256_load_ps(lut +  0);               \
+        __m256 im = _mm256_load_ps(lut +  8);               \
+        __m256 re0 = _mm256_load_ps(lut + 16);              \
+        __m256 im0 = _mm256_load_ps(lut + 24);              \
+        __m256 re1 = _mm256_load_ps(lut + 32);              \
+        __m256 im1 = _mm256_load_ps(lut + 40);              \
+                                                            \
+        __m256 r0 = _mm256_load_ps(d0);                     \
+        __m256 r1 = _mm256_load_ps(d1);                     \
+        __m256 r2 = _mm256_load_ps(d2);                     \
+        __m256 r3 = _mm256_load_ps(d3);                     \
+        __m256 r4 = _mm256_load_ps(d4);                     \
+        __m256 r5 = _mm256_load_ps(d5);                     \
+        __m256 r6 = _mm256_load_ps(d6);                     \
+        __m256 r7 = _mm256_load_ps(d7);                     \
+                                                            \
+        OKFFT_FMA_KN(re, im, r0, r1, r2, r3);               \
+        OKFFT_FMA_KNKN(re0, im0, re1, im1,  r0, r2, r4, r6, \
+                                            r1, r3, r5, r7);\
+                                                            \
+        _mm256_store_ps(d0, r0);                            \
+        _mm256_store_ps(d1, r1);                            \
+        _mm256_store_ps(d2, r2);                            \
+        _mm256_store_ps(d3, r3);                            \
+        _mm256_store_ps(d4, r4);                            \
+        _mm256_store_ps(d5, r5);                            \
+        _mm256_store_ps(d6, r6);                            \
+        _mm256_store_ps(d7, r7);                            \
+                                                            \
+        lut += 48;                                          \
+        d0 += 8; d1 += 8; d2 += 8; d3 += 8;                 \
+        d4 += 8; d5 += 8; d6 += 8; d7 += 8;                 \
+    }                                                       \
+}
+
+#define OKFFT_FMA_X8(N, data, p_lut) OKFFT_FMA_X8_PART(N, data, p_lut, 0, (N) / 4)
+
+#define OKFFT_FMA_X8_32(data, p_lut)                        \
+{                                                           \
+    const float *__restrict lut = (p_lut);                  \
+    __m256 re  = _mm256_load_ps(lut +  0);                  \
+    __m256 im  = _mm256_load_ps(lut +  8);                  \
+    __m256 re0 = _mm256_load_ps(lut + 16);                  \
+    __m256 im0 = _mm256_load_ps(lut + 24);                  \
+    __m256 re1 = _mm256_load_ps(lut + 32);                  \
+    __m256 im1 = _mm256_load_ps(lut + 40);                  \
+                                                            \
+    __m256 r0 = _mm256_load_ps(data +  0);                  \
+    __m256 r1 = _mm256_load_ps(data +  8);                  \
+    __m256 r2 = _mm256_load_ps(data + 16);                  \
+    __m256 r3 = _mm256_load_ps(data + 24);                  \
+    __m256 r4 = _mm256_load_ps(data + 32);                  \
+    __m256 r5 = _mm256_load_ps(data + 40);                  \
+    __m256 r6 = _mm256_load_ps(data + 48);                  \
+    __m256 r7 = _mm256_load_ps(data + 56);                  \
+                                                            \
+    OKFFT_FMA_KN(re, im, r0, r1, r2, r3);                   \
+    OKFFT_FMA_KNKN(re0, im0, re1, im1,  r0, r2, r4, r6,     \
+                                        r1, r3, r5, r7);    \
+                                                            \
+    _mm256_store_ps(data +  0, r0);                         \
+    _mm256_store_ps(data +  8, r1);                         \
+    _mm256_store_ps(data + 16, r2);                         \
+    _mm256_store_ps(data + 24, r3);                         \
+    _mm256_store_ps(data + 32, r4);                         \
+    _mm256_store_ps(data + 40, r5);                         \
+    _mm256_store_ps(data + 48, r6);                         \
+    _mm256_store_ps(data + 56, r7);                         \
+}
+
+#define OKFFT_FMA_LEAF_EE(out, os, in, is)              \
+{                                                       \
+    const float *__restrict LUT = avx_constants;        \
+    __m256 r0, r1, r2, r3, r4, r5, r6, r7;              \
+    float *__restrict out00 = out + os[0];              \
+    float *__restrict out01 = out + os[1];              \
+    float *__restrict out10 = out + os[2];              \
+    float *__restrict out11 = out + os[3];              \
+                                                        \
+    OKFFT_AVX_L4(in + is[0], in + is[1], in + is[2], in + is[3], r0, r1, r2, r3);   \
+    OKFFT_AVX_L2(in + is[4], in + is[5], in + is[6], in + is[7], r4, r5, r6, r7);   \
+                                                        \
+    __m256 re = _mm256_load_ps(LUT + 0);                \
+    __m256 im = _mm256_load_ps(LUT + 8);                \
+    OKFFT_AVX_K0(r0, r2, r4, r6);                       \
+    OKFFT_FMA_KN(re, im, r1, r3, r5, r7);               \
+                                                        \
+    OKFFT_AVX_TX2(r0, r1);                              \
+    OKFFT_AVX_TX2(r2, r3);                              \
+    OKFFT_AVX_TX2(r4, r5);                              \
+    OKFFT_AVX_TX2(r6, r7);                              \
+                                                        \
+    okfft_avx_store4(out00, out10, r0, r2, r4, r6);     \
+    okfft_avx_store4(out01, out11, r1, r3, r5, r7);     \
+}
+
+#define OKFFT_FMA_LEAF_EE2(out, os, in, is)             \
+{                                                       \
+    const float *__restrict LUT = avx_constants;        \
+    __m256 r0, r1, r2, r3, r4, r5, r6, r7;              \
+    float *__restrict out00 = out + os[0];              \
+    float *__restrict out01 = out + os[1];              \
+    float *__restrict out10 = out + os[2];              \
+    float *__restrict out11 = out + os[3];              \
+                                                        \
+    OKFFT_AVX_L4(in + is[6], in + is[7], in + is[4], in + is[5], r0, r1, r2, r3);   \
+    OKFFT_AVX_L2(in + is[0], in + is[1], in + is[3], in + is[2], r4, r5, r6, r7);   \
+                                                        \
+    __m256 re = _mm256_load_ps(LUT + 0);                \
+    __m256 im = _mm256_load_ps(LUT + 8);                \
+    OKFFT_AVX_K0(r0, r2, r4, r6);                       \
+    OKFFT_FMA_KN(re, im, r1, r3, r5, r7);               \
+                                                        \
+    OKFFT_AVX_TX2(r0, r1);                              \
+    OKFFT_AVX_TX2(r2, r3);                              \
+    OKFFT_AVX_TX2(r4, r5);                              \
+    OKFFT_AVX_TX2(r6, r7);                              \
+                                                        \
+    okfft_avx_store4(out00, out10, r0, r2, r4, r6);     \
+    okfft_avx_store4(out01, out11, r1, r3, r5, r7);     \
+}
+
+#define OKFFT_FMA_FP_EVEN(i0, i1, p, p_out, p_in)       \
+{                                                       \
+    float *__restrict out = p_out;                      \
+    const float *__restrict in = p_in;                  \
+    const ptrdiff_t *__restrict is = p->is;             \
+    const uint32_t *__restrict os = p->offsets;         \
+                                                        \
+    for (size_t i = i0 >> 1; i > 0; --i)                \
+    {                                                   \
+        OKFFT_FMA_LEAF_EE(out, os, in, is);             \
+        in += 8; os += 4;                               \
+    }                                                   \
+                                                        \
+    OKFFT_SSE_LEAF_EE(out, os, in, is);                 \
+    in += 4; os += 2;                                   \
+                                                        \
+    OKFFT_SSE_LEAF_EO(out, os, in, is);                 \
+    in += 4; os += 2;                                   \
+                                                        \
+    for (size_t i = i1 >> 1; i > 0; --i)                \
+    {                                                   \
+        OKFFT_AVX_LEAF_OO(out, os, in, is);             \
+        in += 8; os += 4;                               \
+    }                                                   \
+                                                        \
+    OKFFT_SSE_LEAF_OO(out, os, in, is);                 \
+    in += 4; os += 2;                                   \
+                                                        \
+    for (size_t i = i1 >> 1; i > 0; --i)                \
+    {                                                   \
+        OKFFT_FMA_LEAF_EE2(out, os, in, is);            \
+        in += 8; os += 4;                               \
+    }                                                   \
+                                                        \
+    OKFFT_SSE_LEAF_EE2(out, os, in, is);                \
+}
+
+#define OKFFT_FMA_FP_ODD(i0, i1, p, p_out, p_in)        \
+{                                                       \
+    float *__restrict out = p_out;                      \
+    const float *__restrict in = p_in;                  \
+    const ptrdiff_t *__restrict is = p->is;             \
+    const uint32_t *__restrict os = p->offsets;         \
+                                                        \
+    for (size_t i = i0 >> 1; i > 0; --i)                \
+    {                                                   \
+        OKFFT_FMA_LEAF_EE(out, os, in, is);             \
+        in += 8;                                        \
+        os += 4;                                        \
+    }                                                   \
+                                                        \
+    OKFFT_SSE_LEAF_EE(out, os, in, is);                 \
+    in += 4; os += 2;                                   \
+                                                        \
+    for (size_t i = i1 >> 1; i > 0; --i)                \
+    {                                                   \
+        OKFFT_AVX_LEAF_OO(out, os, in, is);             \
+        in += 8;                                        \
+        os += 4;                                        \
+    }                                                   \
+                                                        \
+    OKFFT_SSE_LEAF_OE(out, os, in, is);                 \
+    in += 4;                                            \
+    os += 2;                                            \
+                                                        \
+    for (size_t i = i1 >> 1; i > 0; --i)                \
+    {                                                   \
+        OKFFT_FMA_LEAF_EE2(out, os, in, is);            \
+        in += 8;                                        \
+        os += 4;                                        \
+    }                                                   \
+}
+
+#define OKFFT_FMA_XF_32(data)                       \
+{                                                   \
+    OKFFT_FMA_X8_32(data, ws1);                     \
+}
+
+#define OKFFT_FMA_XF_64(data)                       \
+{                                                   \
+    OKFFT_FMA_X4(data + 0,  ws);                    \
+    OKFFT_FMA_X4X4(data + 64, ws);                  \
+    OKFFT_FMA_X8(64, data, ws + (ws_is[2] << 1));   \
+}
+
+#define OKFFT_FMA_XF_128(data)                      \
+{                                                   \
+    OKFFT_FMA_X4X4(data + 64, ws);                  \
+    OKFFT_FMA_X8_32(data +   0, ws1);               \
+    OKFFT_FMA_X8_32(data + 128, ws1);               \
+    OKFFT_FMA_X8_32(data + 192, ws1);               \
+    OKFFT_FMA_X8(128, data, ws + (ws_is[3] << 1));  \
+}
+
+#define OKFFT_FMA_XF_256(data)                      \
+{                                                   \
+    OKFFT_FMA_XF_64(data);                          \
+    OKFFT_FMA_XF_32(data + 2 * 64);                 \
+    OKFFT_FMA_XF_32(data + 3 * 64);                 \
+    OKFFT_FMA_XF_64(data + 4 * 64);                 \
+    OKFFT_FMA_XF_64(data + 6 * 64);                 \
+    OKFFT_FMA_X8(256, data, ws + (ws_is[4] << 1));  \
+}
+
+#define OKFFT_FMA_XF_512(data)                      \
+{                                                   \
+    OKFFT_FMA_XF_128(data);                         \
+    OKFFT_FMA_XF_64(data +  2 * 128);               \
+    OKFFT_FMA_XF_64(data +  3 * 128);               \
+    OKFFT_FMA_XF_128(data + 4 * 128);               \
+    OKFFT_FMA_XF_128(data + 6 * 128);               \
+    OKFFT_FMA_X8(512, data, ws + (ws_is[5] << 1));  \
+}
+
+#define OKFFT_FMA_XF_1024(data)                     \
+{                                                   \
+    OKFFT_FMA_XF_256(data);                         \
+    OKFFT_FMA_XF_128(data + 2 * 256);               \
+    OKFFT_FMA_XF_128(data + 3 * 256);               \
+    OKFFT_FMA_XF_256(data + 4 * 256);               \
+    OKFFT_FMA_XF_256(data + 6 * 256);               \
+    OKFFT_FMA_X8(1024, data, ws + (ws_is[6] << 1)); \
+}
+
+#endif
+
+#ifdef OKFFT_HAS_AVX512
+
+// 16 wide variants of the AVX kernels. Every 128 bit lane holds two complex values,
+// exactly like the SSE and AVX kernels, so all shuffles stay within lanes and a zmm
+// register simply carries four leafs / four butterflies side by side.
+// AVX512F has no float xor, so the sign swap goes through the integer domain.
+
+#define okfft_avx512_xor(x, y)       _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x), _mm512_castps_si512(y)))
+#define okfft_avx512_swap_pairs(x)   _mm512_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1))
+#define okfft_avx512_swap_sign(x)    okfft_avx512_xor(x, avx512_sign_mask)
+#define okfft_avx512_unpack_lo(x, y) _mm512_shuffle_ps(x, y, _MM_SHUFFLE(1, 0, 1, 0))
+#define okfft_avx512_unpack_hi(x, y) _mm512_shuffle_ps(x, y, _MM_SHUFFLE(3, 2, 3, 2))
+
+// transposes the 128 bit lanes of r0..r3 so that lane k of every register ends up in base[k]
+#define okfft_avx512_store4(base0, base1, base2, base3, r0, r1, r2, r3) \
+{                                                                   \
+    __m512 s0 = _mm512_shuffle_f32x4(r0, r1, _MM_SHUFFLE(1, 0, 1, 0)); \
+    __m512 s1 = _mm512_shuffle_f32x4(r0, r1, _MM_SHUFFLE(3, 2, 3, 2)); \
+    __m512 s2 = _mm512_shuffle_f32x4(r2, r3, _MM_SHUFFLE(1, 0, 1, 0)); \
+    __m512 s3 = _mm512_shuffle_f32x4(r2, r3, _MM_SHUFFLE(3, 2, 3, 2)); \
+                                                                    \
+    _mm512_storeu_ps(base0, _mm512_shuffle_f32x4(s0, s2, _MM_SHUFFLE(2, 0, 2, 0))); \
+    _mm512_storeu_ps(base1, _mm512_shuffle_f32x4(s0, s2, _MM_SHUFFLE(3, 1, 3, 1))); \
+    _mm512_storeu_ps(base2, _mm512_shuffle_f32x4(s1, s3, _MM_SHUFFLE(2, 0, 2, 0))); \
+    _mm512_storeu_ps(base3, _mm512_shuffle_f32x4(s1, s3, _MM_SHUFFLE(3, 1, 3, 1))); \
+}
+
+#define OKFFT_AVX512_KN(re, im, r0, r1, r2, r3)             \
+{                                                           \
+    __m512 uk = r0, uk2 = r1;                               \
+    __m512 r2r = _mm512_mul_ps(re, r2);                     \
+    __m512 r3r = _mm512_mul_ps(re, r3);                     \
+                                                            \
+    r2 = okfft_avx512_swap_pairs(r2);                       \
+    r3 = okfft_avx512_swap_pairs(r3);                       \
+                                                            \
+    __m512 zk_p = _mm512_fnmadd_ps(im, r2, r2r);            \
+    __m512 zk_n = _mm512_fmadd_ps(im, r3, r3r);             \
+                                                            \
+    __m512 zk   = _mm512_add_ps(zk_p, zk_n);                \
+    __m512 zk_d = _mm512_sub_ps(zk_p, zk_n);                \
+                                                            \
+    r2 = _mm512_sub_ps(uk, zk);                             \
+    r0 = _mm512_add_ps(uk, zk);                             \
+                                                            \
+    zk_d = okfft_avx512_swap_sign(zk_d);                    \
+    zk_d = okfft_avx512_swap_pairs(zk_d);                   \
+                                                            \
+    r3 = _mm512_add_ps(uk2, zk_d);                          \
+    r1 = _mm512_sub_ps(uk2, zk_d);                          \
+}
+
+#define OKFFT_AVX512_KNKN(re0, im0, re1, im1, r00, r10, r20, r30, r01, r11, r21, r31)  \
+{                                                       \
+    __m512 uk0  = r00, uk20 = r10;                      \
+    __m512 uk1  = r01, uk21 = r11;                      \
+    __m512 r20r = _mm512_mul_ps(re0, r20);              \
+    __m512 r21r = _mm512_mul_ps(re1, r21);              \
+    __m512 r30r = _mm512_mul_ps(re0, r30);              \
+    __m512 r31r = _mm512_mul_ps(re1, r31);              \
+                                                        \
+    r20 = okfft_avx512_swap_pairs(r20);                 \
+    r21 = okfft_avx512_swap_pairs(r21);                 \
+    r30 = okfft_avx512_swap_pairs(r30);                 \
+    r31 = okfft_avx512_swap_pairs(r31);                 \
+                                                        \
+    __m512 zk_p0 = _mm512_fnmadd_ps(im0, r20, r20r);    \
+    __m512 zk_p1 = _mm512_fnmadd_ps(im1, r21, r21r);    \
+    __m512 zk_n0 = _mm512_fmadd_ps(im0, r30, r30r);     \
+    __m512 zk_n1 = _mm512_fmadd_ps(im1, r31, r31r);     \
+                                                        \
+    __m512 zk0   = _mm512_add_ps(zk_p0, zk_n0);         \
+    __m512 zk1   = _mm512_add_ps(zk_p1, zk_n1);         \
+    __m512 zk_d0 = _mm512_sub_ps(zk_p0, zk_n0);         \
+    __m512 zk_d1 = _mm512_sub_ps(zk_p1, zk_n1);         \
+                                                        \
+    r20 = _mm512_sub_ps(uk0, zk0);                      \
+    r21 = _mm512_sub_ps(uk1, zk1);                      \
+    r00 = _mm512_add_ps(uk0, zk0);                      \
+    r01 = _mm512_add_ps(uk1, zk1);                      \
+                                                        \
+    zk_d0 = okfft_avx512_swap_sign(zk_d0);              \
+    zk_d1 = okfft_avx512_swap_sign(zk_d1);              \
+    zk_d0 = okfft_avx512_swap_pairs(zk_d0);             \
+    zk_d1 = okfft_avx512_swap_pairs(zk_d1);             \
+                                                        \
+    r30 = _mm512_add_ps(uk20, zk_d0);                   \
+    r31 = _mm512_add_ps(uk21, zk_d1);                   \
+    r10 = _mm512_sub_ps(uk20, zk_d0);                   \
+    r11 = _mm512_sub_ps(uk21, zk_d1);                   \
+}
+
+// only valid for N >= 64, the twiddles for smaller passes use the AVX x8 layout
+// radix 8 combine pass over N values, '_PART' does floats [begin, end) of each of the 8 streams (multiples of 16)
+#define OKFFT_AVX512_X8_PART(N, data, p_lut, begin, end)    \
+{                                                           \
+    const size_t OFFS = N / 4;                              \
+    const float *__restrict lut = (p_lut) + 6 * (begin);    \
+    float *__restrict d0 = data + (0 * OFFS) + (begin);     \
+    float *__restrict d1 = data + (1 * OFFS) + (begin);     \
+    float *__restrict d2 = data + (2 * OFFS) + (begin);     \
+    float *__restrict d3 = data + (3 * OFFS) + (begin);     \
+    float *__restrict d4 = data + (4 * OFFS) + (begin);     \
+    float *__restrict d5 = data + (5 * OFFS) + (begin);     \
+    float *__restrict d6 = data + (6 * OFFS) + (begin);     \
+    float *__restrict d7 = data + (7 * OFFS) + (begin);     \
+                                                            \
+    for (size_t i = (begin); i < (end); i += 16)            \
+    {                                                       \
+        __m512 re  = _mm512_load_ps(lut +  0);              \
+        __m512 im  = _mm512_load_ps(lut + 16);              \
+        __m512 re0 = _mm512_load_ps(lut + 32);              \
+        __m512 im0 = _mm512_load_ps(lut + 48);              \
+        __m512 re1 = _mm512_load_ps(lut + 64);              \
+        __m512 im1 = _mm512_load_ps(lut + 80);              \
+                                                            \
+        __m512 r0 = _mm512_loadu_ps(d0);                    \
+        __m512 r1 = _mm512_loadu_ps(d1);                    \
+        __m512 r2 = _mm512_loadu_ps(d2);                    \
+        __m512 r3 = _mm512_loadu_ps(d3);                    \
+        __m512 r4 = _mm512_loadu_ps(d4);                    \
+        __m512 r5 = _mm512_loadu_ps(d5);                    \
+        __m512 r6 = _mm512_loadu_ps(d6);                    \
+        __m512 r7 = _mm512_loadu_ps(d7);                    \
+                                                            \
+        OKFFT_AVX512_KN(re, im, r0, r1, r2, r3);            \
+        OKFFT_AVX512_KNKN(re0, im0, re1, im1, r0, r2, r4, r6, \
+                                              r1, r3, r5, r7);\
+                                                            \
+        _mm512_storeu_ps(d0, r0);                           \
+        _mm512_storeu_ps(d1, r1);                           \
+        _mm512_storeu_ps(d2, r2);                           \
+        _mm512_storeu_ps(d3, r3);                           \
+        _mm512_storeu_ps(d4, r4);                           \
+        _mm512_storeu_ps(d5, r5);                           \
+        _mm512_storeu_ps(d6, r6);                           \
+        _mm512_storeu_ps(d7, r7);                           \
+                                                            \
+        lut += 96;                                          \
+        d0 += 16; d1 += 16; d2 += 16; d3 += 16;             \
+        d4 += 16; d5 += 16; d6 += 16; d7 += 16;             \
+    }                                                       \
+}
+
+#define OKFFT_AVX512_X8(N, data, p_lut) OKFFT_AVX512_X8_PART(N, data, p_lut, 0, (N) / 4)
+
+#define OKFFT_AVX512_TX2(a, b)                          \
+{                                                       \
+    __m512 q0 = okfft_avx512_unpack_lo(a, b);           \
+    __m512 q1 = okfft_avx512_unpack_hi(a, b);           \
+    a = q0;                                             \
+    b = q1;                                             \
+}
+
+#define OKFFT_AVX512_L2(i0, i1, i2, i3, r0, r1, r2, r3) \
+{                                                       \
+    __m512 t0 = _mm512_loadu_ps(i0);                    \
+    __m512 t1 = _mm512_loadu_ps(i1);                    \
+    __m512 t2 = _mm512_loadu_ps(i2);                    \
+    __m512 t3 = _mm512_loadu_ps(i3);                    \
+                                                        \
+    r0 = _mm512_add_ps(t0, t1);                         \
+    r1 = _mm512_sub_ps(t0, t1);                         \
+    r2 = _mm512_add_ps(t2, t3);                         \
+    r3 = _mm512_sub_ps(t2, t3);                         \
+}
+
+#define OKFFT_AVX512_L4(i0, i1, i2, i3, r0, r1, r2, r3) \
+{                                                       \
+    __m512 t0 = _mm512_loadu_ps(i0);                    \
+    __m512 t1 = _mm512_loadu_ps(i1);                    \
+    __m512 t2 = _mm512_loadu_ps(i2);                    \
+    __m512 t3 = _mm512_loadu_ps(i3);                    \
+                                                        \
+    __m512 t4 = _mm512_add_ps(t0, t1);                  \
+    __m512 t5 = _mm512_sub_ps(t0, t1);                  \
+    __m512 t6 = _mm512_add_ps(t2, t3);                  \
+    __m512 t7 = _mm512_sub_ps(t2, t3);                  \
+                                                        \
+    t7 = okfft_avx512_swap_sign(t7);                    \
+    t7 = okfft_avx512_swap_pairs(t7);                   \
+                                                        \
+    r0 = _mm512_add_ps(t4, t6);                         \
+    r2 = _mm512_sub_ps(t4, t6);                         \
+    r1 = _mm512_sub_ps(t5, t7);                         \
+    r3 = _mm512_add_ps(t5, t7);                         \
+}
+
+#define OKFFT_AVX512_L44(i0, i1, i2, i3, r0, r1, r2, r3) \
+{                                                       \
+    __m512 t0 = _mm512_loadu_ps(i0);                    \
+    __m512 t1 = _mm512_loadu_ps(i1);                    \
+    __m512 t2 = _mm512_loadu_ps(i2);                    \
+    __m512 t3 = _mm512_loadu_ps(i3);                    \
+                                                        \
+    __m512 t4 = _mm512_add_ps(t0, t1);                  \
+    __m512 t5 = _mm512_sub_ps(t0, t1);                  \
+    __m512 t6 = _mm512_add_ps(t2, t3);                  \
+    __m512 t7 = _mm512_sub_ps(t2, t3);                  \
+                                                        \
+    t7 = okfft_avx512_swap_sign(t7);                    \
+    t7 = okfft_avx512_swap_pairs(t7);                   \
+                                                        \
+    t0 = _mm512_add_ps(t4, t6);                         \
+    t2 = _mm512_sub_ps(t4, t6);                         \
+    t1 = _mm512_sub_ps(t5, t7);                         \
+    t3 = _mm512_add_ps(t5, t7);                         \
+                                                        \
+    OKFFT_AVX512_TX2(t0, t1);                           \
+    OKFFT_AVX512_TX2(t2, t3);                           \
+                                                        \
+    r0 = t0;                                            \
+    r2 = t1;                                            \
+    r1 = t2;                                            \
+    r3 = t3;                                            \
+}
+
+#define OKFFT_AVX512_K0(r0, r1, r2, r3)                 \
+{                                                       \
+    __m512 t0 = r0;                                     \
+    __m512 t1 = r1;                                     \
+                                                        \
+    __m512 t2 = _mm512_add_ps(r2, r3);                  \
+    __m512 t3 = _mm512_sub_ps(r2, r3);                  \
+                                                        \
+    t3 = okfft_avx512_swap_sign(t3);                    \
+    t3 = okfft_avx512_swap_pairs(t3);                   \
+                                                        \
+    r0 = _mm512_add_ps(t0, t2);                         \
+    r2 = _mm512_sub_ps(t0, t2);                         \
+    r1 = _mm512_sub_ps(t1, t3);                         \
+    r3 = _mm512_add_ps(t1, t3);                         \
+}
+
+#define OKFFT_AVX512_LEAF_EE(out, os, in, is)           \
+{                                                       \
+    const float *__restrict LUT = avx512_constants;     \
+    __m512 r0, r1, r2, r3, r4, r5, r6, r7;              \
+                                                        \
+    OKFFT_AVX512_L4(in + is[0], in + is[1], in + is[2], in + is[3], r0, r1, r2, r3);    \
+    OKFFT_AVX512_L2(in + is[4], in + is[5], in + is[6], in + is[7], r4, r5, r6, r7);    \
+                                                        \
+    __m512 re = _mm512_load_ps(LUT +  0);               \
+    __m512 im = _mm512_load_ps(LUT + 16);               \
+    OKFFT_AVX512_K0(r0, r2, r4, r6);                    \
+    OKFFT_AVX512_KN(re, im, r1, r3, r5, r7);            \
+                                                        \
+    OKFFT_AVX512_TX2(r0, r1);                           \
+    OKFFT_AVX512_TX2(r2, r3);                           \
+    OKFFT_AVX512_TX2(r4, r5);                           \
+    OKFFT_AVX512_TX2(r6, r7);                           \
+                                                        \
+    okfft_avx512_store4(out + os[0], out + os[2], out + os[4], out + os[6], r0, r2, r4, r6);    \
+    okfft_avx512_store4(out + os[1], out + os[3], out + os[5], out + os[7], r1, r3, r5, r7);    \
+}
+
+#define OKFFT_AVX512_LEAF_OO(out, os, in, is)           \
+{                                                       \
+    __m512 r0, r1, r2, r3, r4, r5, r6, r7;              \
+                                                        \
+    OKFFT_AVX512_L44(in + is[0], in + is[1], in + is[2], in + is[3], r0, r1, r2, r3);   \
+    OKFFT_AVX512_L44(in + is[6], in + is[7], in + is[4], in + is[5], r4, r5, r6, r7);   \
+                                                        \
+    okfft_avx512_store4(out + os[0], out + os[2], out + os[4], out + os[6], r0, r1, r4, r5);    \
+    okfft_avx512_store4(out + os[1], out + os[3], out + os[5], out + os[7], r2, r3, r6, r7);    \
+}
+
+#define OKFFT_AVX512_LEAF_EE2(out, os, in, is)          \
+{                                                       \
+    const float *__restrict LUT = avx512_constants;     \
+    __m512 r0, r1, r2, r3, r4, r5, r6, r7;              \
+                                                        \
+    OKFFT_AVX512_L4(in + is[6], in + is[7], in + is[4], in + is[5], r0, r1, r2, r3);    \
+    OKFFT_AVX512_L2(in + is[0], in + is[1], in + is[3], in + is[2], r4, r5, r6, r7);    \
+                                                        \
+    __m512 re = _mm512_load_ps(LUT +  0);               \
+    __m512 im = _mm512_load_ps(LUT + 16);               \
+    OKFFT_AVX512_K0(r0, r2, r4, r6);                    \
+    OKFFT_AVX512_KN(re, im, r1, r3, r5, r7);            \
+                                                        \
+    OKFFT_AVX512_TX2(r0, r1);                           \
+    OKFFT_AVX512_TX2(r2, r3);                           \
+    OKFFT_AVX512_TX2(r4, r5);                           \
+    OKFFT_AVX512_TX2(r6, r7);                           \
+                                                        \
+    okfft_avx512_store4(out + os[0], out + os[2], out + os[4], out + os[6], r0, r2, r4, r6);    \
+    okfft_avx512_store4(out + os[1], out + os[3], out + os[5], out + os[7], r1, r3, r5, r7);    \
+}
+
+// leafs are done four at a time, the remainder falls back to the AVX and SSE leafs
+#define OKFFT_AVX512_FP_EVEN(i0, i1, p, p_out, p_in)    \
+{                                                       \
+    float *__restrict out = p_out;                      \
+    const float *__restrict in = p_in;                  \
+    const ptrdiff_t *__restrict is = p->is;             \
+    const uint32_t *__restrict os = p->offsets;         \
+                                                        \
+    for (size_t i = i0 >> 2; i > 0; --i)                \
+    {                                                   \
+        OKFFT_AVX512_LEAF_EE(out, os, in, is);          \
+        in += 16; os += 8;                              \
+    }                                                   \
+                                                        \
+    if (i0 & 2)                                         \
+    {                                                   \
+        OKFFT_FMA_LEAF_EE(out, os, in, is);             \
+        in += 8; os += 4;                               \
+    }                                                   \
+                                                        \
+    OKFFT_SSE_LEAF_EE(out, os, in, is);                 \
+    in += 4; os += 2;                                   \
+                                                        \
+    OKFFT_SSE_LEAF_EO(out, os, in, is);                 \
+    in += 4; os += 2;                                   \
+                                                        \
+    for (size_t i = i1 >> 2; i > 0; --i)                \
+    {                                                   \
+        OKFFT_AVX512_LEAF_OO(out, os, in, is);          \
+        in += 16; os += 8;                              \
+    }                                                   \
+                                                        \
+    if (i1 & 2)                                         \
+    {                                                   \
+        OKFFT_AVX_LEAF_OO(out, os, in, is);             \
+        in += 8; os += 4;                               \
+    }                                                   \
+                                                        \
+    OKFFT_SSE_LEAF_OO(out, os, in, is);                 \
+    in += 4; os += 2;                                   \
+                                                        \
+    for (size_t i = i1 >> 2; i > 0; --i)                \
+    {                                                   \
+        OKFFT_AVX512_LEAF_EE2(out, os, in, is);         \
+        in += 16; os += 8;                              \
+    }                                                   \
+                                                        \
+    if (i1 & 2)                                         \
+    {                                                   \
+        OKFFT_FMA_LEAF_EE2(out, os, in, is);            \
+        in += 8; os += 4;                               \
+    }                                                   \
+                                                        \
+    OKFFT_SSE_LEAF_EE2(out, os, in, is);                \
+}
+
+#define OKFFT_AVX512_FP_ODD(i0, i1, p, p_out, p_in)     \
+{                                                       \
+    float *__restrict out = p_out;                      \
+    const float *__restrict in = p_in;                  \
+    const ptrdiff_t *__restrict is = p->is;             \
+    const uint32_t *__restrict os = p->offsets;         \
+                                                        \
+    for (size_t i = i0 >> 2; i > 0; --i)                \
+    {                                                   \
+        OKFFT_AVX512_LEAF_EE(out, os, in, is);          \
+        in += 16; os += 8;                              \
+    }                                                   \
+                                                        \
+    if (i0 & 2)                                         \
+    {                                                   \
+        OKFFT_FMA_LEAF_EE(out, os, in, is);             \
+        in += 8; os += 4;                               \
+    }                                                   \
+                                                        \
+    OKFFT_SSE_LEAF_EE(out, os, in, is);                 \
+    in += 4; os += 2;                                   \
+                                                        \
+    for (size_t i = i1 >> 2; i > 0; --i)                \
+    {                                                   \
+        OKFFT_AVX512_LEAF_OO(out, os, in, is);          \
+        in += 16; os += 8;                              \
+    }                                                   \
+                                                        \
+    if (i1 & 2)                                         \
+    {                                                   \
+        OKFFT_AVX_LEAF_OO(out, os, in, is);             \
+        in += 8; os += 4;                               \
+    }                                                   \
+                                                        \
+    OKFFT_SSE_LEAF_OE(out, os, in, is);                 \
+    in += 4; os += 2;                                   \
+                                                        \
+    for (size_t i = i1 >> 2; i > 0; --i)                \
+    {                                                   \
+        OKFFT_AVX512_LEAF_EE2(out, os, in, is);         \
+        in += 16; os += 8;                              \
+    }                                                   \
+                                                        \
+    if (i1 & 2)                                         \
+    {                                                   \
+        OKFFT_FMA_LEAF_EE2(out, os, in, is);            \
+        in += 8; os += 4;                               \
+    }                                                   \
+}
+
+#define OKFFT_AVX512_XF_32(data)                    \
+{                                                   \
+    OKFFT_FMA_X8_32(data, ws1);                     \
+}
+
+#define OKFFT_AVX512_XF_64(data)                    \
+{                                                   \
+    OKFFT_FMA_X4(data + 0,  ws);                    \
+    OKFFT_FMA_X4X4(data + 64, ws);                  \
+    OKFFT_AVX512_X8(64, data, ws + (ws_is[2] << 1));\
+}
+
+#define OKFFT_AVX512_XF_128(data)                   \
+{                                                   \
+    OKFFT_FMA_X4X4(data + 64, ws);                  \
+    OKFFT_FMA_X8_32(data +   0, ws1);               \
+    OKFFT_FMA_X8_32(data + 128, ws1);               \
+    OKFFT_FMA_X8_32(data + 192, ws1);               \
+    OKFFT_AVX512_X8(128, data, ws + (ws_is[3] << 1)); \
+}
+
+#define OKFFT_AVX512_XF_256(data)                   \
+{                                                   \
+    OKFFT_AVX512_XF_64(data);                       \
+    OKFFT_AVX512_XF_32(data + 2 * 64);              \
+    OKFFT_AVX512_XF_32(data + 3 * 64);              \
+    OKFFT_AVX512_XF_64(data + 4 * 64);              \
+    OKFFT_AVX512_XF_64(data + 6 * 64);              \
+    OKFFT_AVX512_X8(256, data, ws + (ws_is[4] << 1)); \
+}
+
+#define OKFFT_AVX512_XF_512(data)                   \
+{                                                   \
+    OKFFT_AVX512_XF_128(data);                      \
+    OKFFT_AVX512_XF_64(data +  2 * 128);            \
+    OKFFT_AVX512_XF_64(data +  3 * 128);            \
+    OKFFT_AVX512_XF_128(data + 4 * 128);            \
+    OKFFT_AVX512_XF_128(data + 6 * 128);            \
+    OKFFT_AVX512_X8(512, data, ws + (ws_is[5] << 1)); \
+}
+
+#define OKFFT_AVX512_XF_1024(data)                  \
+{                                                   \
+    OKFFT_AVX512_XF_256(data);                      \
+    OKFFT_AVX512_XF_128(data + 2 * 256);            \
+    OKFFT_AVX512_XF_128(data + 3 * 256);            \
+    OKFFT_AVX512_XF_256(data + 4 * 256);            \
+    OKFFT_AVX512_XF_256(data + 6 * 256);            \
+    OKFFT_AVX512_X8(1024, data, ws + (ws_is[6] << 1)); \
+}
+
+#endif
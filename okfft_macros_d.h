@@ -0,0 +1,529 @@
+/*
+This file is part of OKFFT
+
+BSD 3-Clause License
+
+Copyright (c) 2012, 2013, Anthony M. Blake <amb@anthonix.com>
+Copyright (c) 2012, The University of Waikato
+Copyright (c) 2015, Jukka Ojanen <jukka.ojanen@kolumbus.fi>
+Copyright (c) 2017, Espen Andreassen <espandre@gmail.com>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+* Neither the name of the organization nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ANTHONY M. BLAKE BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+#include "okfft.h"
+
+// Double precision variants of the SSE leaf, X4 and X8 machinery.
+//
+// A double vector 'okfft_vd' holds two complex values, exactly like an SSE float register, so the
+// offsets, input indices and (duplicated re / im) twiddle layout of the float kernels carry over
+// unchanged, just counted in doubles. The including file picks the vector type and defines:
+//
+//   okfft_vd_load(p), okfft_vd_loadu(p), okfft_vd_store(p, x)
+//   okfft_vd_add(x, y), okfft_vd_sub(x, y), okfft_vd_mul(x, y)
+//   okfft_vd_swap_pairs(x)      swaps re and im of both complex values
+//   okfft_vd_swap_sign(x)       xor with the local 'vd_sign_mask'
+//   okfft_vd_unpack_lo(x, y)    { x[0], y[0] } (complex values)
+//   okfft_vd_unpack_hi(x, y)    { x[1], y[1] }
+//   okfft_vd_blend(x, y)        { x[0], y[1] }
+//
+// The leaf loads read the user input and go through 'okfft_vd_loadu', everything else works on the
+// (aligned) output.
+
+#define okfft_vd_store4(base, r0, r1, r2, r3)               \
+{                                                           \
+    okfft_vd_store(base +  0, r0);                          \
+    okfft_vd_store(base +  4, r1);                          \
+    okfft_vd_store(base +  8, r2);                          \
+    okfft_vd_store(base + 12, r3);                          \
+}
+
+#define OKFFT_VD_KN(re, im, r0, r1, r2, r3)                 \
+{                                                           \
+    okfft_vd uk = r0, uk2 = r1;                             \
+    okfft_vd r2r = okfft_vd_mul(re, r2);                    \
+    okfft_vd r3r = okfft_vd_mul(re, r3);                    \
+                                                            \
+    r2 = okfft_vd_swap_pairs(r2);                           \
+    r3 = okfft_vd_swap_pairs(r3);                           \
+                                                            \
+    okfft_vd r2i = okfft_vd_mul(im, r2);                    \
+    okfft_vd r3i = okfft_vd_mul(im, r3);                    \
+                                                            \
+    okfft_vd zk_p = okfft_vd_sub(r2r, r2i);                 \
+    okfft_vd zk_n = okfft_vd_add(r3r, r3i);                 \
+                                                            \
+    okfft_vd zk   = okfft_vd_add(zk_p, zk_n);               \
+    okfft_vd zk_d = okfft_vd_sub(zk_p, zk_n);               \
+                                                            \
+    r2 = okfft_vd_sub(uk, zk);                              \
+    r0 = okfft_vd_add(uk, zk);                              \
+                                                            \
+    zk_d = okfft_vd_swap_sign(zk_d);                        \
+    zk_d = okfft_vd_swap_pairs(zk_d);                       \
+                                                            \
+    r3 = okfft_vd_add(uk2, zk_d);                           \
+    r1 = okfft_vd_sub(uk2, zk_d);                           \
+}
+
+#define OKFFT_VD_KNKN(re0, im0, re1, im1, r00, r10, r20, r30, r01, r11, r21, r31) \
+{                                                           \
+    okfft_vd uk0  = r00, uk20 = r10;                        \
+    okfft_vd uk1  = r01, uk21 = r11;                        \
+    okfft_vd r20r = okfft_vd_mul(re0, r20);                 \
+    okfft_vd r21r = okfft_vd_mul(re1, r21);                 \
+    okfft_vd r30r = okfft_vd_mul(re0, r30);                 \
+    okfft_vd r31r = okfft_vd_mul(re1, r31);                 \
+                                                            \
+    r20 = okfft_vd_swap_pairs(r20);                         \
+    r21 = okfft_vd_swap_pairs(r21);                         \
+    r30 = okfft_vd_swap_pairs(r30);                         \
+    r31 = okfft_vd_swap_pairs(r31);                         \
+                                                            \
+    okfft_vd r20i = okfft_vd_mul(im0, r20);                 \
+    okfft_vd r21i = okfft_vd_mul(im1, r21);                 \
+    okfft_vd r30i = okfft_vd_mul(im0, r30);                 \
+    okfft_vd r31i = okfft_vd_mul(im1, r31);                 \
+                                                            \
+    okfft_vd zk_p0 = okfft_vd_sub(r20r, r20i);              \
+    okfft_vd zk_p1 = okfft_vd_sub(r21r, r21i);              \
+    okfft_vd zk_n0 = okfft_vd_add(r30r, r30i);              \
+    okfft_vd zk_n1 = okfft_vd_add(r31r, r31i);              \
+                                                            \
+    okfft_vd zk0   = okfft_vd_add(zk_p0, zk_n0);            \
+    okfft_vd zk1   = okfft_vd_add(zk_p1, zk_n1);            \
+    okfft_vd zk_d0 = okfft_vd_sub(zk_p0, zk_n0);            \
+    okfft_vd zk_d1 = okfft_vd_sub(zk_p1, zk_n1);            \
+                                                            \
+    r20 = okfft_vd_sub(uk0, zk0);                           \
+    r21 = okfft_vd_sub(uk1, zk1);                           \
+    r00 = okfft_vd_add(uk0, zk0);                           \
+    r01 = okfft_vd_add(uk1, zk1);                           \
+                                                            \
+    zk_d0 = okfft_vd_swap_sign(zk_d0);                      \
+    zk_d1 = okfft_vd_swap_sign(zk_d1);                      \
+    zk_d0 = okfft_vd_swap_pairs(zk_d0);                     \
+    zk_d1 = okfft_vd_swap_pairs(zk_d1);                     \
+                                                            \
+    r30 = okfft_vd_add(uk20, zk_d0);                        \
+    r31 = okfft_vd_add(uk21, zk_d1);                        \
+    r10 = okfft_vd_sub(uk20, zk_d0);                        \
+    r11 = okfft_vd_sub(uk21, zk_d1);                        \
+}
+
+#define OKFFT_VD_X4(data, lut)                              \
+{                                                           \
+    okfft_vd r00 = okfft_vd_load(data +  0);                \
+    okfft_vd r01 = okfft_vd_load(data +  4);                \
+    okfft_vd r10 = okfft_vd_load(data +  8);                \
+    okfft_vd r11 = okfft_vd_load(data + 12);                \
+    okfft_vd r20 = okfft_vd_load(data + 16);                \
+    okfft_vd r21 = okfft_vd_load(data + 20);                \
+    okfft_vd r30 = okfft_vd_load(data + 24);                \
+    okfft_vd r31 = okfft_vd_load(data + 28);                \
+                                                            \
+    okfft_vd re0 = okfft_vd_load(lut +  0);                 \
+    okfft_vd im0 = okfft_vd_load(lut +  4);                 \
+    okfft_vd re1 = okfft_vd_load(lut +  8);                 \
+    okfft_vd im1 = okfft_vd_load(lut + 12);                 \
+                                                            \
+    OKFFT_VD_KNKN(re0, im0, re1, im1,  r00, r10, r20, r30,  \
+                                        r01, r11, r21, r31); \
+                                                            \
+    okfft_vd_store(data + 16, r20);                         \
+    okfft_vd_store(data + 20, r21);                         \
+    okfft_vd_store(data +  0, r00);                         \
+    okfft_vd_store(data +  4, r01);                         \
+                                                            \
+    okfft_vd_store(data + 24, r30);                         \
+    okfft_vd_store(data + 28, r31);                         \
+    okfft_vd_store(data +  8, r10);                         \
+    okfft_vd_store(data + 12, r11);                         \
+}
+
+#define OKFFT_VD_X8(N, data, p_lut)                         \
+{                                                           \
+    size_t OFFS = N >> 2;                                   \
+    const double *__restrict lut = (p_lut);                 \
+    double *__restrict d0 = data + (0 * OFFS);              \
+    double *__restrict d1 = data + (1 * OFFS);              \
+    double *__restrict d2 = data + (2 * OFFS);              \
+    double *__restrict d3 = data + (3 * OFFS);              \
+    double *__restrict d4 = data + (4 * OFFS);              \
+    double *__restrict d5 = data + (5 * OFFS);              \
+    double *__restrict d6 = data + (6 * OFFS);              \
+    double *__restrict d7 = data + (7 * OFFS);              \
+                                                            \
+    for (size_t i = 0; i < (N >> 4); i++)                   \
+    {                                                       \
+        okfft_vd r0 = okfft_vd_load(d0);                    \
+        okfft_vd r1 = okfft_vd_load(d1);                    \
+        okfft_vd r2 = okfft_vd_load(d2);                    \
+        okfft_vd r3 = okfft_vd_load(d3);                    \
+        okfft_vd r4 = okfft_vd_load(d4);                    \
+        okfft_vd r5 = okfft_vd_load(d5);                    \
+        okfft_vd r6 = okfft_vd_load(d6);                    \
+        okfft_vd r7 = okfft_vd_load(d7);                    \
+                                                            \
+        okfft_vd re = okfft_vd_load(lut + 0);               \
+        okfft_vd im = okfft_vd_load(lut + 4);               \
+                                                            \
+        OKFFT_VD_KN(re, im, r0, r1, r2, r3);                \
+                                                            \
+        okfft_vd re0 = okfft_vd_load(lut +  8);             \
+        okfft_vd im0 = okfft_vd_load(lut + 12);             \
+        okfft_vd re1 = okfft_vd_load(lut + 16);             \
+        okfft_vd im1 = okfft_vd_load(lut + 20);             \
+                                                            \
+        OKFFT_VD_KNKN(re0, im0, re1, im1,  r0, r2, r4, r6,  \
+                                            r1, r3, r5, r7); \
+                                                            \
+        okfft_vd_store(d0, r0);                             \
+        okfft_vd_store(d1, r1);                             \
+        okfft_vd_store(d2, r2);                             \
+        okfft_vd_store(d3, r3);                             \
+        okfft_vd_store(d4, r4);                             \
+        okfft_vd_store(d5, r5);                             \
+        okfft_vd_store(d6, r6);                             \
+        okfft_vd_store(d7, r7);                             \
+                                                            \
+        lut += 24;                                          \
+        d0 += 4; d1 += 4; d2 += 4; d3 += 4;                 \
+        d4 += 4; d5 += 4; d6 += 4; d7 += 4;                 \
+    }                                                       \
+}
+
+#define OKFFT_VD_TX2(a, b)                                  \
+{                                                           \
+    okfft_vd q0 = okfft_vd_unpack_lo(a, b);                 \
+    okfft_vd q1 = okfft_vd_unpack_hi(a, b);                 \
+    a = q0;                                                 \
+    b = q1;                                                 \
+}
+
+#define OKFFT_VD_L2(i0, i1, i2, i3, r0, r1, r2, r3)         \
+{                                                           \
+    okfft_vd t0 = okfft_vd_loadu(i0);                       \
+    okfft_vd t1 = okfft_vd_loadu(i1);                       \
+    okfft_vd t2 = okfft_vd_loadu(i2);                       \
+    okfft_vd t3 = okfft_vd_loadu(i3);                       \
+                                                            \
+    r0 = okfft_vd_add(t0, t1);                              \
+    r1 = okfft_vd_sub(t0, t1);                              \
+    r2 = okfft_vd_add(t2, t3);                              \
+    r3 = okfft_vd_sub(t2, t3);                              \
+}
+
+#define OKFFT_VD_L4(i0, i1, i2, i3, r0, r1, r2, r3)         \
+{                                                           \
+    okfft_vd t0 = okfft_vd_loadu(i0);                       \
+    okfft_vd t1 = okfft_vd_loadu(i1);                       \
+    okfft_vd t2 = okfft_vd_loadu(i2);                       \
+    okfft_vd t3 = okfft_vd_loadu(i3);                       \
+                                                            \
+    okfft_vd t4 = okfft_vd_add(t0, t1);                     \
+    okfft_vd t5 = okfft_vd_sub(t0, t1);                     \
+    okfft_vd t6 = okfft_vd_add(t2, t3);                     \
+    okfft_vd t7 = okfft_vd_sub(t2, t3);                     \
+                                                            \
+    t7 = okfft_vd_swap_sign(t7);                            \
+    t7 = okfft_vd_swap_pairs(t7);                           \
+                                                            \
+    r0 = okfft_vd_add(t4, t6);                              \
+    r2 = okfft_vd_sub(t4, t6);                              \
+    r1 = okfft_vd_sub(t5, t7);                              \
+    r3 = okfft_vd_add(t5, t7);                              \
+}
+
+#define OKFFT_VD_L44(i0, i1, i2, i3, r0, r1, r2, r3)        \
+{                                                           \
+    okfft_vd t0 = okfft_vd_loadu(i0);                       \
+    okfft_vd t1 = okfft_vd_loadu(i1);                       \
+    okfft_vd t2 = okfft_vd_loadu(i2);                       \
+    okfft_vd t3 = okfft_vd_loadu(i3);                       \
+                                                            \
+    okfft_vd t4 = okfft_vd_add(t0, t1);                     \
+    okfft_vd t5 = okfft_vd_sub(t0, t1);                     \
+    okfft_vd t6 = okfft_vd_add(t2, t3);                     \
+    okfft_vd t7 = okfft_vd_sub(t2, t3);                     \
+                                                            \
+    t7 = okfft_vd_swap_sign(t7);                            \
+    t7 = okfft_vd_swap_pairs(t7);                           \
+                                                            \
+    t0 = okfft_vd_add(t4, t6);                              \
+    t2 = okfft_vd_sub(t4, t6);                              \
+    t1 = okfft_vd_sub(t5, t7);                              \
+    t3 = okfft_vd_add(t5, t7);                              \
+                                                            \
+    OKFFT_VD_TX2(t0, t1);                                   \
+    OKFFT_VD_TX2(t2, t3);                                   \
+                                                            \
+    r0 = t0;                                                \
+    r2 = t1;                                                \
+    r1 = t2;                                                \
+    r3 = t3;                                                \
+}
+
+#define OKFFT_VD_L42(i0, i1, i2, i3, r0, r1, r2, r3)        \
+{                                                           \
+    okfft_vd t0 = okfft_vd_loadu(i0);                       \
+    okfft_vd t1 = okfft_vd_loadu(i1);                       \
+    okfft_vd t6 = okfft_vd_loadu(i2);                       \
+    okfft_vd t7 = okfft_vd_loadu(i3);                       \
+                                                            \
+    okfft_vd t2 = okfft_vd_blend(t6, t7);                   \
+    okfft_vd t3 = okfft_vd_blend(t7, t6);                   \
+                                                            \
+    okfft_vd t4 = okfft_vd_add(t0, t1);                     \
+    okfft_vd t5 = okfft_vd_sub(t0, t1);                     \
+           t6 = okfft_vd_add(t2, t3);                       \
+           t7 = okfft_vd_sub(t2, t3);                       \
+                                                            \
+    r2 = okfft_vd_unpack_hi(t4, t5);                        \
+    r3 = okfft_vd_unpack_hi(t6, t7);                        \
+                                                            \
+    t7 = okfft_vd_swap_sign(t7);                            \
+    t7 = okfft_vd_swap_pairs(t7);                           \
+                                                            \
+    t0 = okfft_vd_add(t4, t6);                              \
+    t2 = okfft_vd_sub(t4, t6);                              \
+    t1 = okfft_vd_sub(t5, t7);                              \
+    t3 = okfft_vd_add(t5, t7);                              \
+                                                            \
+    r0 = okfft_vd_unpack_lo(t0, t1);                        \
+    r1 = okfft_vd_unpack_lo(t2, t3);                        \
+}
+
+#define OKFFT_VD_L24(i0, i1, i2, i3, r0, r1, r2, r3)        \
+{                                                           \
+    okfft_vd t0 = okfft_vd_loadu(i0);                       \
+    okfft_vd t1 = okfft_vd_loadu(i1);                       \
+    okfft_vd t2 = okfft_vd_loadu(i2);                       \
+    okfft_vd t3 = okfft_vd_loadu(i3);                       \
+                                                            \
+    okfft_vd t4 = okfft_vd_add(t0, t1);                     \
+    okfft_vd t5 = okfft_vd_sub(t0, t1);                     \
+    okfft_vd t6 = okfft_vd_add(t2, t3);                     \
+    okfft_vd t7 = okfft_vd_sub(t2, t3);                     \
+                                                            \
+    r0 = okfft_vd_unpack_lo(t4, t5);                        \
+    r1 = okfft_vd_unpack_lo(t6, t7);                        \
+                                                            \
+    t5 = okfft_vd_swap_sign(t5);                            \
+    t5 = okfft_vd_swap_pairs(t5);                           \
+                                                            \
+    t0 = okfft_vd_add(t6, t4);                              \
+    t2 = okfft_vd_sub(t6, t4);                              \
+    t1 = okfft_vd_sub(t7, t5);                              \
+    t3 = okfft_vd_add(t7, t5);                              \
+                                                            \
+    r3 = okfft_vd_unpack_hi(t0, t1);                        \
+    r2 = okfft_vd_unpack_hi(t2, t3);                        \
+}
+
+#define OKFFT_VD_K0(r0, r1, r2, r3)                         \
+{                                                           \
+    okfft_vd t0 = r0;                                       \
+    okfft_vd t1 = r1;                                       \
+                                                            \
+    okfft_vd  t2 = okfft_vd_add(r2, r3);                    \
+    okfft_vd  t3 = okfft_vd_sub(r2, r3);                    \
+            t3 = okfft_vd_swap_sign(t3);                    \
+            t3 = okfft_vd_swap_pairs(t3);                   \
+                                                            \
+    r0 = okfft_vd_add(t0, t2);                              \
+    r2 = okfft_vd_sub(t0, t2);                              \
+    r1 = okfft_vd_sub(t1, t3);                              \
+    r3 = okfft_vd_add(t1, t3);                              \
+}
+
+#define OKFFT_VD_LEAF_EE(out, os, in, is)                   \
+{                                                           \
+    const double *__restrict LUT = vd_constants;            \
+    okfft_vd r0, r1, r2, r3, r4, r5, r6, r7;                \
+    double *__restrict out0 = out + os[0];                  \
+    double *__restrict out1 = out + os[1];                  \
+                                                            \
+    OKFFT_VD_L4(in + is[0], in + is[1], in + is[2], in + is[3], r0, r1, r2, r3); \
+    OKFFT_VD_L2(in + is[4], in + is[5], in + is[6], in + is[7], r4, r5, r6, r7); \
+                                                            \
+    okfft_vd re = okfft_vd_load(LUT + 0);                   \
+    okfft_vd im = okfft_vd_load(LUT + 4);                   \
+    OKFFT_VD_K0(r0, r2, r4, r6);                            \
+    OKFFT_VD_KN(re, im, r1, r3, r5, r7);                    \
+                                                            \
+    OKFFT_VD_TX2(r0, r1);                                   \
+    OKFFT_VD_TX2(r2, r3);                                   \
+    OKFFT_VD_TX2(r4, r5);                                   \
+    OKFFT_VD_TX2(r6, r7);                                   \
+                                                            \
+    okfft_vd_store4(out0, r0, r2, r4, r6);                  \
+    okfft_vd_store4(out1, r1, r3, r5, r7);                  \
+}
+
+#define OKFFT_VD_LEAF_EO(out, os, in, is)                   \
+{                                                           \
+    const double *__restrict LUT = vd_constants;            \
+    okfft_vd r0, r1, r2, r3, r4, r5, r6, r7;                \
+    double *__restrict out0 = out + os[0];                  \
+    double *__restrict out1 = out + os[1];                  \
+                                                            \
+    OKFFT_VD_L44(in + is[0], in + is[1], in + is[2], in + is[3], r0, r1, r2, r3); \
+    OKFFT_VD_L24(in + is[4], in + is[5], in + is[6], in + is[7], r4, r5, r6, r7); \
+                                                            \
+    okfft_vd_store4(out1, r2, r3, r7, r6);                  \
+                                                            \
+    okfft_vd re = okfft_vd_load(LUT +  8);                  \
+    okfft_vd im = okfft_vd_load(LUT + 12);                  \
+    OKFFT_VD_KN(re, im, r0, r1, r4, r5);                    \
+                                                            \
+    okfft_vd_store4(out0, r0, r1, r4, r5);                  \
+}
+
+#define OKFFT_VD_LEAF_OE(out, os, in, is)                   \
+{                                                           \
+    const double *__restrict LUT = vd_constants;            \
+    okfft_vd r0, r1, r2, r3, r4, r5, r6, r7;                \
+    double *__restrict out0 = out + os[0];                  \
+    double *__restrict out1 = out + os[1];                  \
+                                                            \
+    OKFFT_VD_L42(in + is[0], in + is[1], in + is[2], in + is[3], r0, r1, r2, r3); \
+    OKFFT_VD_L44(in + is[6], in + is[7], in + is[4], in + is[5], r4, r5, r6, r7); \
+                                                            \
+    okfft_vd_store4(out0, r0, r1, r4, r5);                  \
+                                                            \
+    okfft_vd re = okfft_vd_load(LUT +  8);                  \
+    okfft_vd im = okfft_vd_load(LUT + 12);                  \
+    OKFFT_VD_KN(re, im, r6, r7, r2, r3);                    \
+                                                            \
+    okfft_vd_store4(out1, r6, r7, r2, r3);                  \
+}
+
+#define OKFFT_VD_LEAF_OO(out, os, in, is)                   \
+{                                                           \
+    okfft_vd r0, r1, r2, r3, r4, r5, r6, r7;                \
+    double *__restrict out0 = out + os[0];                  \
+    double *__restrict out1 = out + os[1];                  \
+                                                            \
+    OKFFT_VD_L44(in + is[0], in + is[1], in + is[2], in + is[3], r0, r1, r2, r3); \
+    OKFFT_VD_L44(in + is[6], in + is[7], in + is[4], in + is[5], r4, r5, r6, r7); \
+                                                            \
+    okfft_vd_store4(out0, r0, r1, r4, r5);                  \
+    okfft_vd_store4(out1, r2, r3, r6, r7);                  \
+}
+
+#define OKFFT_VD_LEAF_EE2(out, os, in, is)                  \
+{                                                           \
+    const double *__restrict LUT = vd_constants;            \
+    okfft_vd r0, r1, r2, r3, r4, r5, r6, r7;                \
+    double *__restrict out0 = out + os[0];                  \
+    double *__restrict out1 = out + os[1];                  \
+                                                            \
+    OKFFT_VD_L4(in + is[6], in + is[7], in + is[4], in + is[5], r0, r1, r2, r3); \
+    OKFFT_VD_L2(in + is[0], in + is[1], in + is[3], in + is[2], r4, r5, r6, r7); \
+                                                            \
+    okfft_vd re = okfft_vd_load(LUT + 0);                   \
+    okfft_vd im = okfft_vd_load(LUT + 4);                   \
+    OKFFT_VD_K0(r0, r2, r4, r6);                            \
+    OKFFT_VD_KN(re, im, r1, r3, r5, r7);                    \
+                                                            \
+    OKFFT_VD_TX2(r0, r1);                                   \
+    OKFFT_VD_TX2(r2, r3);                                   \
+    OKFFT_VD_TX2(r4, r5);                                   \
+    OKFFT_VD_TX2(r6, r7);                                   \
+                                                            \
+    okfft_vd_store4(out0, r0, r2, r4, r6);                  \
+    okfft_vd_store4(out1, r1, r3, r5, r7);                  \
+}
+
+#define OKFFT_VD_FP_EVEN(i0, i1, p, p_out, p_in)            \
+{                                                           \
+    double *__restrict out = p_out;                         \
+    const double *__restrict in = p_in;                     \
+    const ptrdiff_t *__restrict is = p->is;                 \
+    const uint32_t *__restrict os = p->offsets;             \
+                                                            \
+    for (size_t i = i0; i > 0; --i)                         \
+    {                                                       \
+        OKFFT_VD_LEAF_EE(out, os, in, is);                  \
+        in += 4;                                            \
+        os += 2;                                            \
+    }                                                       \
+                                                            \
+    OKFFT_VD_LEAF_EO(out, os, in, is);                      \
+    in += 4;                                                \
+    os += 2;                                                \
+                                                            \
+    for (size_t i = i1; i > 0; --i)                         \
+    {                                                       \
+        OKFFT_VD_LEAF_OO(out, os, in, is);                  \
+        in += 4;                                            \
+        os += 2;                                            \
+    }                                                       \
+                                                            \
+    for (size_t i = i1; i > 0; --i)                         \
+    {                                                       \
+        OKFFT_VD_LEAF_EE2(out, os, in, is);                 \
+        in += 4;                                            \
+        os += 2;                                            \
+    }                                                       \
+}
+
+#define OKFFT_VD_FP_ODD(i0, i1, p, p_out, p_in)             \
+{                                                           \
+    double *__restrict out = p_out;                         \
+    const double *__restrict in = p_in;                     \
+    const ptrdiff_t *__restrict is = p->is;                 \
+    const uint32_t *__restrict os = p->offsets;             \
+                                                            \
+    for (size_t i = i0; i > 0; --i)                         \
+    {                                                       \
+        OKFFT_VD_LEAF_EE(out, os, in, is);                  \
+        in += 4;                                            \
+        os += 2;                                            \
+    }                                                       \
+                                                            \
+    for (size_t i = i1; i > 0; --i)                         \
+    {                                                       \
+        OKFFT_VD_LEAF_OO(out, os, in, is);                  \
+        in += 4;                                            \
+        os += 2;                                            \
+    }                                                       \
+                                                            \
+    OKFFT_VD_LEAF_OE(out, os, in, is);                      \
+    in += 4;                                                \
+    os += 2;                                                \
+                                                            \
+    for (size_t i = i1; i > 0; --i)                         \
+    {                                                       \
+        OKFFT_VD_LEAF_EE2(out, os, in, is);                 \
+        in += 4;                                            \
+        os += 2;                                            \
+    }                                                       \
+}
@@ -0,0 +1,312 @@
+/*
+This file is part of OKFFT
+
+BSD 3-Clause License
+
+Copyright (c) 2012, 2013, Anthony M. Blake <amb@anthonix.com>
+Copyright (c) 2012, The University of Waikato
+Copyright (c) 2015, Jukka Ojanen <jukka.ojanen@kolumbus.fi>
+Copyright (c) 2017, Espen Andreassen <espandre@gmail.com>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+* Neither the name of the organization nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ANTHONY M. BLAKE BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "okfft.h"
+
+#include <stdio.h>  // for printf (default log)
+#include <string.h> // for memcpy
+#include <chrono>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#else
+    #include <x86intrin.h>
+#endif
+
+#if !defined(_WIN32)
+    #include <sys/mman.h> // for mmap, madvise, msync
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// Out of core xforms of four step plans: the same decomposition as 'okfft_layout_fourstep', but as two passes over
+// memory that may be far larger than ram (a mapped file), each streaming blocks of whole columns through a working
+// buffer of fixed size. 'output' holds the intermediate, so nothing else of size N is needed:
+//
+//  1. blocks of columns of the N2 x N1 input are gathered (a short run from every row), transformed, twiddled and
+//     written as consecutive rows of the N1 x N2 matrix Y^T in 'output' (one contiguous run per block)
+//  2. blocks of columns of Y^T are gathered, transformed along n1 and scattered back where they came from, which
+//     leaves X[k2 + N2 * k1] in natural order
+//
+// The strips of the next block are handed to the kernel with MADV_WILLNEED while the current one is transformed,
+// and written ranges of a file are queued for writeback right away so dirty pages don't pile up.
+
+void okfft_layout_tile_gather(float *__restrict out, const float *__restrict in, size_t rows, size_t ld, size_t w);
+void okfft_layout_tile_scatter(float *__restrict out, const float *__restrict in, size_t rows, size_t ld, size_t w);
+void okfft_layout_fourstep_twiddle(const okfft_plan_t *plan, float *__restrict col, size_t rows, size_t n1);
+
+typedef std::chrono::steady_clock okfft_ooc_clock_t;
+
+static double okfft_ooc_seconds(okfft_ooc_clock_t::time_point &t)
+{
+    okfft_ooc_clock_t::time_point now = okfft_ooc_clock_t::now();
+    double s = std::chrono::duration<double>(now - t).count();
+    t = now;
+    return s;
+}
+
+#if !defined(_WIN32)
+static size_t okfft_ooc_page()
+{
+    static const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    return page;
+}
+
+// readahead for 'rows' strips of 'bytes' starting every 'ld' bytes from 'p'. Pages holding the start of a strip
+// were already advised with the block before (unless 'first'), so only the pages after them are.
+static void okfft_ooc_willneed(const float *p, size_t rows, size_t ld, size_t bytes, bool first)
+{
+    const uintptr_t page = okfft_ooc_page();
+
+    for (size_t r = 0; r < rows; r++)
+    {
+        uintptr_t begin = (uintptr_t) p + ld * r;
+        uintptr_t end = (begin + bytes + page - 1) & ~(page - 1);
+        begin = first ? begin & ~(page - 1) : (begin + page - 1) & ~(page - 1);
+
+        if (begin < end)
+            madvise((void *) begin, end - begin, MADV_WILLNEED);
+    }
+}
+
+// starts the writeback of a range of a mapped file
+static void okfft_ooc_writeback(float *p, size_t bytes)
+{
+    const uintptr_t page = okfft_ooc_page();
+    uintptr_t begin = (uintptr_t) p & ~(page - 1);
+    msync((void *) begin, (uintptr_t) p + bytes - begin, MS_ASYNC);
+}
+#else
+static void okfft_ooc_willneed(const float *, size_t, size_t, size_t, bool) {}
+static void okfft_ooc_writeback(float *, size_t) {}
+#endif
+
+static double okfft_ooc_log2(size_t n)
+{
+    double l = 0.0;
+    for (; n > 1; n >>= 1)
+        l += 1.0;
+    return l;
+}
+
+static void okfft_ooc_rate(okfft_ooc_pass_t *pass, double flops)
+{
+    pass->io_mb_per_s = pass->io_seconds > 0.0 ? pass->bytes / pass->io_seconds * 1e-6 : 0.0;
+    pass->gflops = pass->compute_seconds > 0.0 ? flops / pass->compute_seconds * 1e-9 : 0.0;
+}
+
+static bool okfft_ooc_run(const okfft_plan_t *plan, float *output, const float *input, size_t buffer_bytes, bool file, okfft_ooc_stats_t *stats)
+{
+    if (!plan->fs_ws)
+    {
+        OKFFT_LOG("Out of core xforms need a plan from 'okfft_create_plan_fourstep'.\n");
+        return false;
+    }
+
+    const size_t N2 = plan->dims[0], N1 = plan->dims[1];
+    const okfft_plan_t *col_plan = plan->dim_plans[0];
+    const okfft_plan_t *row_plan = plan->dim_plans[1];
+
+    // a block and its transformed copy, whole columns of N2 (pass 1) and N1 (pass 2) complex values
+    size_t cols = buffer_bytes / (16 * N2);
+    size_t rows = buffer_bytes / (16 * N1);
+    cols = cols < N1 ? cols : N1;
+    rows = rows < N2 ? rows : N2;
+
+    if (!cols)
+    {
+        OKFFT_LOG("Out of core buffer of %zu bytes is too small, at least %zu needed.\n", buffer_bytes, 16 * N2);
+        return false;
+    }
+
+    float *__restrict a = (float *) OKFFT_ALLOC_TEMP_ALIGNED_DATA(16 * N2 * cols > 16 * N1 * rows ? 16 * N2 * cols : 16 * N1 * rows);
+    if (!a)
+        return false;
+
+    okfft_ooc_stats_t s;
+    memset(&s, 0, sizeof(s));
+    okfft_ooc_clock_t::time_point t = okfft_ooc_clock_t::now();
+
+    // pass 1, the columns of the input into the rows of Y^T
+    float *__restrict b = a + 2 * N2 * cols;
+    okfft_ooc_willneed(input, N2, 8 * N1, 8 * cols, true);
+
+    for (size_t c = 0; c < N1; c += cols)
+    {
+        const size_t w = N1 - c < cols ? N1 - c : cols;
+
+        okfft_layout_tile_gather(a, input + 2 * c, N2, N1, w);
+
+        if (c + w < N1)
+            okfft_ooc_willneed(input + 2 * (c + w), N2, 8 * N1, 8 * (N1 - c - w < cols ? N1 - c - w : cols), false);
+        s.pass[0].io_seconds += okfft_ooc_seconds(t);
+
+        for (size_t i = 0; i < w; i++)
+        {
+            col_plan->xform(col_plan, b + 2 * N2 * i, a + 2 * N2 * i);
+            okfft_layout_fourstep_twiddle(plan, b + 2 * N2 * i, N2, c + i);
+        }
+        s.pass[0].compute_seconds += okfft_ooc_seconds(t);
+
+        memcpy(output + 2 * N2 * c, b, 8 * N2 * w);
+        if (file)
+            okfft_ooc_writeback(output + 2 * N2 * c, 8 * N2 * w);
+        s.pass[0].io_seconds += okfft_ooc_seconds(t);
+    }
+
+    // pass 2, the columns of Y^T in place
+    b = a + 2 * N1 * rows;
+    okfft_ooc_willneed(output, N1, 8 * N2, 8 * rows, true);
+
+    for (size_t r = 0; r < N2; r += rows)
+    {
+        const size_t w = N2 - r < rows ? N2 - r : rows;
+
+        okfft_layout_tile_gather(a, output + 2 * r, N1, N2, w);
+
+        if (r + w < N2)
+            okfft_ooc_willneed(output + 2 * (r + w), N1, 8 * N2, 8 * (N2 - r - w < rows ? N2 - r - w : rows), false);
+        s.pass[1].io_seconds += okfft_ooc_seconds(t);
+
+        for (size_t i = 0; i < w; i++)
+            row_plan->xform(row_plan, b + 2 * N1 * i, a + 2 * N1 * i);
+        s.pass[1].compute_seconds += okfft_ooc_seconds(t);
+
+        okfft_layout_tile_scatter(output + 2 * r, b, N1, N2, w);
+        s.pass[1].io_seconds += okfft_ooc_seconds(t);
+    }
+
+    OKFFT_FREE_TEMP_ALIGNED_DATA(a);
+
+#if !defined(_WIN32)
+    // the rest of the writeback is part of the last pass
+    if (file)
+    {
+        msync(output, 8 * plan->N, MS_SYNC);
+        s.pass[1].io_seconds += okfft_ooc_seconds(t);
+    }
+#endif
+
+    if (stats)
+    {
+        // both passes read and write N complex values, flops by the 5 N log2(N) model of every xform
+        s.pass[0].bytes = s.pass[1].bytes = 16 * plan->N;
+        okfft_ooc_rate(&s.pass[0], 5.0 * N1 * N2 * okfft_ooc_log2(N2));
+        okfft_ooc_rate(&s.pass[1], 5.0 * N2 * N1 * okfft_ooc_log2(N1));
+        *stats = s;
+    }
+
+    return true;
+}
+
+bool okfft_execute_ooc(const okfft_plan_t *plan, float *output, const float *input, size_t buffer_bytes, okfft_ooc_stats_t *stats)
+{
+    return okfft_ooc_run(plan, output, input, buffer_bytes, false, stats);
+}
+
+#if !defined(_WIN32)
+bool okfft_execute_ooc_file(const okfft_plan_t *plan, const char *output_path, const char *input_path, size_t buffer_bytes, okfft_ooc_stats_t *stats)
+{
+    const size_t bytes = 8 * plan->N;
+
+    int in = open(input_path, O_RDONLY);
+    if (in < 0)
+    {
+        OKFFT_LOG("Can't open '%s'.\n", input_path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(in, &st) != 0 || (size_t) st.st_size < bytes)
+    {
+        OKFFT_LOG("'%s' holds less than %zu bytes.\n", input_path, bytes);
+        close(in);
+        return false;
+    }
+
+    // truncated only once it's known not to be the input (through another name or a link)
+    int out = open(output_path, O_RDWR | O_CREAT, 0644);
+    if (out < 0)
+    {
+        OKFFT_LOG("Can't create '%s'.\n", output_path);
+        close(in);
+        return false;
+    }
+
+    struct stat out_st;
+    if (fstat(out, &out_st) != 0 || (out_st.st_dev == st.st_dev && out_st.st_ino == st.st_ino))
+    {
+        OKFFT_LOG("'%s' and '%s' are the same file, out of core xforms of files can't run in place.\n", output_path, input_path);
+        close(out);
+        close(in);
+        return false;
+    }
+
+    if (ftruncate(out, 0) != 0 || ftruncate(out, (off_t) bytes) != 0)
+    {
+        OKFFT_LOG("Can't create '%s'.\n", output_path);
+        close(out);
+        close(in);
+        return false;
+    }
+
+    void *src = mmap(NULL, bytes, PROT_READ, MAP_SHARED, in, 0);
+    void *dst = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, out, 0);
+
+    bool ok = false;
+    if (src == MAP_FAILED || dst == MAP_FAILED)
+        OKFFT_LOG("Can't map '%s' / '%s'.\n", input_path, output_path);
+    else
+        ok = okfft_ooc_run(plan, (float *) dst, (const float *) src, buffer_bytes, true, stats);
+
+    if (src != MAP_FAILED)
+        munmap(src, bytes);
+    if (dst != MAP_FAILED)
+        munmap(dst, bytes);
+    close(out);
+    close(in);
+    return ok;
+}
+#else
+bool okfft_execute_ooc_file(const okfft_plan_t *, const char *, const char *, size_t, okfft_ooc_stats_t *)
+{
+    OKFFT_LOG("Out of core xforms of files are not supported on this OS, map the files and use 'okfft_execute_ooc'.\n");
+    return false;
+}
+#endif
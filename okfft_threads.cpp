@@ -0,0 +1,473 @@
+/*
+This file is part of OKFFT
+
+BSD 3-Clause License
+
+Copyright (c) 2012, 2013, Anthony M. Blake <amb@anthonix.com>
+Copyright (c) 2012, The University of Waikato
+Copyright (c) 2015, Jukka Ojanen <jukka.ojanen@kolumbus.fi>
+Copyright (c) 2017, Espen Andreassen <espandre@gmail.com>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+* Neither the name of the organization nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ANTHONY M. BLAKE BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "okfft.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h> // for SetThreadAffinityMask
+#elif defined(__linux__)
+    #include <pthread.h> // for pthread_setaffinity_np
+#endif
+
+// Xforms split across a pool of worker threads, power of two N only. The split radix passes of N > 64k are five
+// independent sub xforms (N / 4, N / 8, N / 8, N / 4, N / 4) followed by a radix 8 combine that is independent
+// along its 8 streams:
+//
+//  1. the leaf pass in chunks of leafs (the sse leafs of okfft_xf_layout.cpp, their output is the same for every set)
+//  2. the five sub xforms as separate tasks, split again down to 'OKFFT_THREADS_PASSES_N'
+//  3. the combine in slices of its streams
+//
+// Every task list is a job on a shared queue. Idle workers take the newest job first (the innermost sub xform,
+// whose data is still in cache) and the thread that posted a job runs its tasks too until none are left, so
+// nested jobs never wait on a blocked thread. Tasks are coarse (tens of microseconds), a shared queue under
+// one mutex is contended far less than the tasks take.
+
+// Batches (okfft_execute_batch_parallel) are one task per thread, each task takes runs of transforms from a shared
+// counter until the batch is done, so uneven threads (or a user pool busy with other work) still finish together.
+
+// sub xforms below this run on one thread
+#define OKFFT_THREADS_PASSES_N      (128 * 1024)
+
+// leafs per leaf task (16 complex values each), floats per combine stream per combine task
+#define OKFFT_THREADS_LEAFS         1024
+#define OKFFT_THREADS_X8_FLOATS     4096
+
+// runs of transforms per batch thread, short enough to even out at the end of the batch
+#define OKFFT_THREADS_BATCH_RUNS    4
+
+void okfft_layout_leafs_fwd(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input, size_t begin, size_t end);
+void okfft_layout_leafs_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input, size_t begin, size_t end);
+
+// per thread scratch (okfft.cpp)
+float *okfft_thread_scratch(size_t slot, size_t size);
+
+typedef void (*okfft_task_func_t)(void *ctx, size_t i);
+typedef void (*okfft_leafs_func_t)(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input, size_t begin, size_t end);
+
+// POOL
+
+struct okfft_job_t
+{
+    okfft_task_func_t func;
+    void *ctx;
+    size_t count;
+    std::atomic<size_t> next;           // next unclaimed task
+    size_t users;                       // workers running tasks of the job (under the pool lock)
+};
+
+struct okfft_pool_t
+{
+    std::mutex lock;
+    std::condition_variable work;       // workers, a job was posted (or 'stop')
+    std::condition_variable done;       // posting threads, a worker left a job
+    std::vector<okfft_job_t *> jobs;    // jobs that may have unclaimed tasks, newest last
+    std::vector<std::thread> workers;
+    size_t threads;                     // including the posting thread, 0 = one per hardware thread
+    size_t size;                        // 'threads' resolved (0 until the first use)
+    bool pin;                           // worker i on logical cpu i
+    bool started;
+    bool stop;
+
+    ~okfft_pool_t();
+};
+
+static okfft_pool_t okfft_pool;
+
+static void okfft_job_run(okfft_job_t *job)
+{
+    for (size_t i = job->next++; i < job->count; i = job->next++)
+        job->func(job->ctx, i);
+}
+
+static void okfft_job_remove(okfft_pool_t &pool, okfft_job_t *job)
+{
+    for (size_t i = pool.jobs.size(); i > 0; i--)
+    {
+        if (pool.jobs[i - 1] == job)
+        {
+            pool.jobs.erase(pool.jobs.begin() + (i - 1));
+            return;
+        }
+    }
+}
+
+static void okfft_worker(okfft_pool_t *pool)
+{
+    std::unique_lock<std::mutex> lk(pool->lock);
+
+    for (;;)
+    {
+        pool->work.wait(lk, [pool] { return pool->stop || !pool->jobs.empty(); });
+        if (pool->stop)
+            return;
+
+        okfft_job_t *job = pool->jobs.back();
+        job->users++;
+
+        lk.unlock();
+        okfft_job_run(job);
+        lk.lock();
+
+        // all tasks are claimed now, nobody else needs to see the job
+        okfft_job_remove(*pool, job);
+
+        if (--job->users == 0)
+            pool->done.notify_all();
+    }
+}
+
+static size_t okfft_pool_size(okfft_pool_t &pool)
+{
+    if (!pool.size)
+    {
+        const size_t hw = std::thread::hardware_concurrency();
+        pool.size = pool.threads ? pool.threads : hw ? hw : 1;
+    }
+
+    return pool.size;
+}
+
+static void okfft_pin_thread(std::thread &thread, size_t cpu)
+{
+#if defined(_WIN32)
+    if (cpu < 8 * sizeof(DWORD_PTR))
+        SetThreadAffinityMask((HANDLE) thread.native_handle(), (DWORD_PTR) 1 << cpu);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void) thread;
+    (void) cpu;
+#endif
+}
+
+// called under the pool lock
+static void okfft_pool_start(okfft_pool_t &pool)
+{
+    const size_t threads = okfft_pool_size(pool);
+    const size_t cpus = std::thread::hardware_concurrency();
+
+    for (size_t i = 1; i < threads; i++)
+    {
+        pool.workers.push_back(std::thread(okfft_worker, &pool));
+
+        if (pool.pin && cpus)
+            okfft_pin_thread(pool.workers.back(), i % cpus);
+    }
+
+    pool.started = true;
+}
+
+// runs 'func(ctx, i)' for i in [0, count) on the workers and the calling thread, returns when all are done
+static void okfft_pool_for(size_t count, okfft_task_func_t func, void *ctx)
+{
+    okfft_pool_t &pool = okfft_pool;
+
+    okfft_job_t job;
+    job.func = func;
+    job.ctx = ctx;
+    job.count = count;
+    job.next = 0;
+    job.users = 0;
+
+    {
+        std::lock_guard<std::mutex> lk(pool.lock);
+        if (!pool.started)
+            okfft_pool_start(pool);
+
+        if (pool.workers.empty() || count < 2)
+        {
+            job.count = 0;
+        }
+        else
+        {
+            pool.jobs.push_back(&job);
+            pool.work.notify_all();
+        }
+    }
+
+    if (job.count == 0)
+    {
+        // nothing to share
+        for (size_t i = 0; i < count; i++)
+            func(ctx, i);
+
+        return;
+    }
+
+    okfft_job_run(&job);
+
+    std::unique_lock<std::mutex> lk(pool.lock);
+    okfft_job_remove(pool, &job);
+    pool.done.wait(lk, [&job] { return job.users == 0; });
+}
+
+// joins the workers, the next 'okfft_pool_for' starts them again
+static void okfft_pool_stop(okfft_pool_t &pool)
+{
+    std::vector<std::thread> workers;
+
+    {
+        std::lock_guard<std::mutex> lk(pool.lock);
+        pool.stop = true;
+        workers.swap(pool.workers);
+        pool.work.notify_all();
+    }
+
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    std::lock_guard<std::mutex> lk(pool.lock);
+    pool.started = false;
+    pool.stop = false;
+}
+
+okfft_pool_t::~okfft_pool_t()
+{
+    okfft_pool_stop(*this);
+}
+
+void okfft_set_threads(size_t threads)
+{
+    okfft_pool_stop(okfft_pool);
+
+    std::lock_guard<std::mutex> lk(okfft_pool.lock);
+    okfft_pool.threads = threads;
+    okfft_pool.size = 0;
+}
+
+size_t okfft_get_threads()
+{
+    std::lock_guard<std::mutex> lk(okfft_pool.lock);
+    return okfft_pool_size(okfft_pool);
+}
+
+void okfft_set_thread_affinity(bool pin)
+{
+    okfft_pool_stop(okfft_pool);
+
+    std::lock_guard<std::mutex> lk(okfft_pool.lock);
+    okfft_pool.pin = pin;
+}
+
+// PARALLEL XFORMS
+
+struct okfft_parallel_leafs_t
+{
+    const okfft_plan_t *plan;
+    okfft_leafs_func_t leafs;
+    float *output;
+    const float *input;
+};
+
+static void okfft_parallel_leafs_task(void *ctx, size_t i)
+{
+    const okfft_parallel_leafs_t *p = (const okfft_parallel_leafs_t *) ctx;
+    const size_t count = p->plan->N / 16;
+    const size_t end = (i + 1) * OKFFT_THREADS_LEAFS;
+
+    p->leafs(p->plan, p->output, p->input, i * OKFFT_THREADS_LEAFS, end < count ? end : count);
+}
+
+struct okfft_parallel_passes_t
+{
+    const okfft_plan_t *plan;
+    float *data;
+    size_t N;
+};
+
+static void okfft_parallel_passes(const okfft_plan_t *plan, float *data, size_t N);
+
+static void okfft_parallel_sub_task(void *ctx, size_t i)
+{
+    const okfft_parallel_passes_t *p = (const okfft_parallel_passes_t *) ctx;
+    const size_t N = p->N;
+
+    // same sub xforms as the recursive passes of the kernel sets, offsets in floats
+    const size_t offset[5] = { 0, N / 2, N / 2 + N / 4, N, N + N / 2 };
+    const size_t size[5] = { N / 4, N / 8, N / 8, N / 4, N / 4 };
+
+    okfft_parallel_passes(p->plan, p->data + offset[i], size[i]);
+}
+
+static void okfft_parallel_x8_task(void *ctx, size_t i)
+{
+    const okfft_parallel_passes_t *p = (const okfft_parallel_passes_t *) ctx;
+    p->plan->x8(p->plan, p->data, p->N, i * OKFFT_THREADS_X8_FLOATS, (i + 1) * OKFFT_THREADS_X8_FLOATS);
+}
+
+static void okfft_parallel_passes(const okfft_plan_t *plan, float *data, size_t N)
+{
+    if (N < OKFFT_THREADS_PASSES_N)
+    {
+        plan->passes(plan, data, N);
+        return;
+    }
+
+    okfft_parallel_passes_t p = { plan, data, N };
+    okfft_pool_for(5, okfft_parallel_sub_task, &p);
+    okfft_pool_for(N / 4 / OKFFT_THREADS_X8_FLOATS, okfft_parallel_x8_task, &p);
+}
+
+static void okfft_parallel(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input, okfft_leafs_func_t leafs)
+{
+    // the kernel set's own leafs are faster than the sse ones if there is nobody to share with
+    // (reads the pool size without the lock, like everything else 'okfft_set_threads' isn't thread safe with)
+    if (okfft_pool_size(okfft_pool) < 2)
+    {
+        plan->xform_contig(plan, output, input);
+        return;
+    }
+
+    okfft_parallel_leafs_t p = { plan, leafs, output, input };
+    okfft_pool_for((plan->N / 16 + OKFFT_THREADS_LEAFS - 1) / OKFFT_THREADS_LEAFS, okfft_parallel_leafs_task, &p);
+
+    okfft_parallel_passes(plan, output, plan->N);
+}
+
+void okfft_parallel_fwd(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    okfft_parallel(plan, output, input, okfft_layout_leafs_fwd);
+}
+
+void okfft_parallel_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    okfft_parallel(plan, output, input, okfft_layout_leafs_inv);
+}
+
+// PARALLEL BATCHES
+
+struct okfft_batch_t
+{
+    const okfft_plan_t *plan;
+    size_t howmany;
+    const float *input;
+    ptrdiff_t idist;
+    float *output;
+    ptrdiff_t odist;
+    size_t run;                         // transforms taken at a time
+    std::atomic<size_t> next;           // first transform of the next run
+    bool real;
+};
+
+static void okfft_batch_task(void *ctx)
+{
+    okfft_batch_t *b = (okfft_batch_t *) ctx;
+    const okfft_plan_t *plan = b->plan;
+
+    // the unrolled small real xforms don't touch it, the others need N + 2 floats (plan->N is N / 2 for real plans)
+    okfft_buffer_t state = { b->real ? okfft_thread_scratch(OKFFT_SCRATCH_REAL, 2 * plan->N + 2) : NULL };
+
+    for (size_t i = b->next.fetch_add(b->run); i < b->howmany; i = b->next.fetch_add(b->run))
+    {
+        const size_t count = b->howmany - i < b->run ? b->howmany - i : b->run;
+        const float *input = b->input + (ptrdiff_t) i * b->idist;
+        float *output = b->output + (ptrdiff_t) i * b->odist;
+
+        if (b->real)
+            okfft_execute_real_batch(plan, &state, count, input, b->idist, output, b->odist);
+        else
+            okfft_execute_batch(plan, count, input, b->idist, output, b->odist);
+    }
+}
+
+static void okfft_batch_pool_task(void *ctx, size_t)
+{
+    okfft_batch_task(ctx);
+}
+
+static void okfft_batch(const okfft_plan_t *plan, size_t howmany, const float *input, ptrdiff_t idist, float *output, ptrdiff_t odist, const okfft_executor_t *executor, bool real)
+{
+    if (!howmany)
+        return;
+
+    size_t threads = executor ? executor->threads : okfft_pool_size(okfft_pool);
+
+    // 0 = one task per hardware thread, like 'okfft_set_threads'
+    if (!threads)
+    {
+        const size_t hw = std::thread::hardware_concurrency();
+        threads = hw ? hw : 1;
+    }
+
+    if (threads > howmany)
+        threads = howmany;
+
+    const size_t runs = threads * OKFFT_THREADS_BATCH_RUNS;
+
+    okfft_batch_t b;
+    b.plan = plan;
+    b.howmany = howmany;
+    b.input = input;
+    b.idist = idist;
+    b.output = output;
+    b.odist = odist;
+    b.run = (howmany + runs - 1) / runs;
+    b.next = 0;
+    b.real = real;
+
+    if (!executor)
+    {
+        okfft_pool_for(threads, okfft_batch_pool_task, &b);
+        return;
+    }
+
+    for (size_t i = 0; i < threads; i++)
+        executor->submit(executor->ctx, okfft_batch_task, &b);
+
+    executor->wait(executor->ctx);
+}
+
+void okfft_execute_batch_parallel(const okfft_plan_t *plan, size_t howmany, const float *input, ptrdiff_t idist, float *output, ptrdiff_t odist, const okfft_executor_t *executor)
+{
+    okfft_batch(plan, howmany, input, idist, output, odist, executor, false);
+}
+
+void okfft_execute_real_batch_parallel(const okfft_plan_t *plan, size_t howmany, const float *input, ptrdiff_t idist, float *output, ptrdiff_t odist, const okfft_executor_t *executor)
+{
+    okfft_batch(plan, howmany, input, idist, output, odist, executor, true);
+}
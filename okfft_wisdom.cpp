@@ -0,0 +1,544 @@
+/*
+This file is part of OKFFT
+
+BSD 3-Clause License
+
+Copyright (c) 2012, 2013, Anthony M. Blake <amb@anthonix.com>
+Copyright (c) 2012, The University of Waikato
+Copyright (c) 2015, Jukka Ojanen <jukka.ojanen@kolumbus.fi>
+Copyright (c) 2017, Espen Andreassen <espandre@gmail.com>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+* Neither the name of the organization nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ANTHONY M. BLAKE BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "okfft.h"
+
+#include <stdio.h>  // for printf (default log), FILE
+#include <string.h> // for memcmp
+#include <mutex>
+#include <atomic>
+#include <vector>
+
+#if !defined(_WIN32)
+    #include <sys/mman.h> // for mmap
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// Wisdom files hold the tables that are slow to build, the leaf offsets of every size and the largest shared twiddle
+// table of each direction and layout, so an importing process maps them instead of computing them. Layout:
+//   header, plan keys (plan_count), table entries (table_count), table data (each 64 byte aligned)
+// Every value is in the byte order of the exporting machine, a file is only imported by a build with the same version,
+// pointer size and kernel set ('okfft_get_isa').
+
+#define OKFFT_WISDOM_VERSION 1
+#define OKFFT_WISDOM_MAPS    16
+
+static const char okfft_wisdom_magic[8] = { 'O', 'K', 'F', 'F', 'T', 'W', 'I', 'S' };
+
+enum OKFFT_WISDOM_TABLE
+{
+    OKFFT_WISDOM_OFFSETS = 1,           // 'okfft_plan_t::offsets' of N
+    OKFFT_WISDOM_TWIDDLES,              // 'okfft_twiddles_t::ws' of N
+    OKFFT_WISDOM_TWIDDLE_INDICES        // 'okfft_twiddles_t::ws_is' of N
+};
+
+struct okfft_wisdom_header_t
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t isa;
+    uint32_t pointer_size;              // sizeof(ptrdiff_t), of the twiddle indices
+    uint32_t plan_count;
+    uint32_t table_count;
+    uint32_t reserved;
+    uint64_t size;                      // of the whole file
+};
+
+// an 'okfft_get_plan' key, the import puts these plans in the cache
+struct okfft_wisdom_plan_t
+{
+    uint64_t N;
+    uint32_t dir;
+    uint32_t kind;
+};
+
+struct okfft_wisdom_table_t
+{
+    uint32_t type;
+    uint32_t flags;                     // twiddles: inverse in bit 0, the layout above it
+    uint64_t N;
+    uint64_t offset;                    // from the start of the file
+    uint64_t size;                      // in bytes
+};
+
+struct okfft_wisdom_map_t
+{
+    const char *base;
+    size_t size;
+    const okfft_wisdom_table_t *tables;
+    size_t table_count;
+};
+
+// mapped files, published by the count so lookups need no lock, never unmapped (plans point into them)
+static okfft_wisdom_map_t okfft_wisdom_maps[OKFFT_WISDOM_MAPS];
+static std::atomic<size_t> okfft_wisdom_map_count;
+static std::mutex okfft_wisdom_lock;
+
+// internals of okfft.cpp and okfft_cache.cpp (the plans are passed with a reference)
+bool okfft_plan_twiddles(const okfft_plan_t *plan, bool *is_inverse, size_t *layout, size_t *ws_size, size_t *lut_count);
+size_t okfft_twiddles_size(size_t N, size_t *lut_count);
+size_t okfft_plan_offsets_N(size_t N, OKFFT_PLAN_KIND kind);
+void okfft_cache_for_each(void (*fn)(void *ctx, const okfft_plan_t *plan, size_t N, OKFFT_DIRECTION dir, OKFFT_PLAN_KIND kind), void *ctx);
+
+static uint32_t okfft_wisdom_flags(bool is_inverse, size_t layout)
+{
+    return (uint32_t) ((layout << 1) | (is_inverse ? 1 : 0));
+}
+
+static size_t okfft_wisdom_align(size_t size)
+{
+    return (size + 63) & ~(size_t) 63;
+}
+
+// LOOKUP
+
+// the table of the type and flags with the largest N >= 'N' ('exact' for N itself), NULL if none
+static const okfft_wisdom_table_t *okfft_wisdom_find(uint32_t type, uint32_t flags, size_t N, bool exact, const okfft_wisdom_map_t **map)
+{
+    const okfft_wisdom_table_t *best = NULL;
+    const size_t count = okfft_wisdom_map_count.load(std::memory_order_acquire);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const okfft_wisdom_map_t &m = okfft_wisdom_maps[i];
+
+        for (size_t j = 0; j < m.table_count; j++)
+        {
+            const okfft_wisdom_table_t *t = &m.tables[j];
+            if (t->type != type || t->flags != flags || t->N < N || (exact && t->N != N) || (best && best->N >= t->N))
+                continue;
+
+            best = t;
+            *map = &m;
+        }
+    }
+
+    return best;
+}
+
+const uint32_t *okfft_wisdom_offsets(size_t N)
+{
+    const okfft_wisdom_map_t *m;
+    const okfft_wisdom_table_t *t = okfft_wisdom_find(OKFFT_WISDOM_OFFSETS, 0, N, true, &m);
+
+    return t ? (const uint32_t *) (m->base + t->offset) : NULL;
+}
+
+const float *okfft_wisdom_twiddles(size_t N, bool is_inverse, size_t layout, const ptrdiff_t **ws_is, size_t *table_N)
+{
+    const uint32_t flags = okfft_wisdom_flags(is_inverse, layout);
+
+    const okfft_wisdom_map_t *m;
+    const okfft_wisdom_table_t *t = okfft_wisdom_find(OKFFT_WISDOM_TWIDDLES, flags, N, false, &m);
+    if (!t)
+        return NULL;
+
+    // the indices of the same table, written next to it
+    const okfft_wisdom_map_t *mi;
+    const okfft_wisdom_table_t *ti = okfft_wisdom_find(OKFFT_WISDOM_TWIDDLE_INDICES, flags, t->N, true, &mi);
+    if (!ti || mi != m)
+        return NULL;
+
+    *ws_is = (const ptrdiff_t *) (m->base + ti->offset);
+    *table_N = (size_t) t->N;
+    return (const float *) (m->base + t->offset);
+}
+
+bool okfft_wisdom_contains(const void *p)
+{
+    const size_t count = okfft_wisdom_map_count.load(std::memory_order_acquire);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const char *base = okfft_wisdom_maps[i].base;
+        if ((const char *) p >= base && (const char *) p < base + okfft_wisdom_maps[i].size)
+            return true;
+    }
+
+    return false;
+}
+
+// EXPORT
+
+struct okfft_wisdom_export_t
+{
+    std::vector<okfft_wisdom_plan_t> plans;
+    std::vector<const okfft_plan_t *> held;     // references on the cached plans until the file is written
+    std::vector<okfft_wisdom_table_t> tables;
+    std::vector<const void *> data;
+};
+
+static void okfft_wisdom_add_table(okfft_wisdom_export_t *ex, uint32_t type, uint32_t flags, size_t N, const void *data, size_t size)
+{
+    for (size_t i = 0; i < ex->tables.size(); i++)
+    {
+        okfft_wisdom_table_t &t = ex->tables[i];
+        if (t.type != type || t.flags != flags)
+            continue;
+
+        // one offsets table per size, the twiddles of smaller sizes are a prefix of the largest table
+        if (type == OKFFT_WISDOM_OFFSETS ? t.N == N : t.N >= N)
+            return;
+
+        if (type != OKFFT_WISDOM_OFFSETS)
+        {
+            t.N = N;
+            t.size = size;
+            ex->data[i] = data;
+            return;
+        }
+    }
+
+    okfft_wisdom_table_t t = { type, flags, N, 0, size };
+    ex->tables.push_back(t);
+    ex->data.push_back(data);
+}
+
+static void okfft_wisdom_add_plan_tables(okfft_wisdom_export_t *ex, const okfft_plan_t *plan)
+{
+    if (!plan)
+        return;
+
+    if (plan->offsets)
+        okfft_wisdom_add_table(ex, OKFFT_WISDOM_OFFSETS, 0, plan->N, plan->offsets, plan->N / 8 * sizeof(uint32_t));
+
+    bool is_inverse;
+    size_t layout, ws_size, lut_count;
+    if (okfft_plan_twiddles(plan, &is_inverse, &layout, &ws_size, &lut_count))
+    {
+        const uint32_t flags = okfft_wisdom_flags(is_inverse, layout);
+        okfft_wisdom_add_table(ex, OKFFT_WISDOM_TWIDDLES, flags, plan->N, plan->ws, ws_size * sizeof(float));
+        okfft_wisdom_add_table(ex, OKFFT_WISDOM_TWIDDLE_INDICES, flags, plan->N, plan->ws_is, lut_count * sizeof(ptrdiff_t));
+    }
+
+    okfft_wisdom_add_plan_tables(ex, plan->sub);
+
+    for (size_t i = 0; i < plan->rank; i++)
+        okfft_wisdom_add_plan_tables(ex, plan->dim_plans[i]);
+}
+
+static void okfft_wisdom_add_plan(void *ctx, const okfft_plan_t *plan, size_t N, OKFFT_DIRECTION dir, OKFFT_PLAN_KIND kind)
+{
+    okfft_wisdom_export_t *ex = (okfft_wisdom_export_t *) ctx;
+
+    ex->held.push_back(plan);
+
+    okfft_wisdom_plan_t p = { N, (uint32_t) dir, (uint32_t) kind };
+    ex->plans.push_back(p);
+
+    okfft_wisdom_add_plan_tables(ex, plan);
+}
+
+static bool okfft_wisdom_write(FILE *f, const okfft_wisdom_export_t &ex)
+{
+    okfft_wisdom_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, okfft_wisdom_magic, sizeof(h.magic));
+    h.version = OKFFT_WISDOM_VERSION;
+    h.isa = (uint32_t) okfft_get_isa();
+    h.pointer_size = (uint32_t) sizeof(ptrdiff_t);
+    h.plan_count = (uint32_t) ex.plans.size();
+    h.table_count = (uint32_t) ex.tables.size();
+
+    std::vector<okfft_wisdom_table_t> tables = ex.tables;
+
+    size_t offset = okfft_wisdom_align(sizeof(h) + ex.plans.size() * sizeof(okfft_wisdom_plan_t) + tables.size() * sizeof(okfft_wisdom_table_t));
+    for (size_t i = 0; i < tables.size(); i++)
+    {
+        tables[i].offset = offset;
+        offset += okfft_wisdom_align((size_t) tables[i].size);
+    }
+
+    h.size = offset;
+
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    if (!ex.plans.empty())
+        ok = ok && fwrite(&ex.plans[0], sizeof(okfft_wisdom_plan_t), ex.plans.size(), f) == ex.plans.size();
+    if (!tables.empty())
+        ok = ok && fwrite(&tables[0], sizeof(okfft_wisdom_table_t), tables.size(), f) == tables.size();
+
+    static const char zeros[64] = { 0 };
+    size_t pos = sizeof(h) + ex.plans.size() * sizeof(okfft_wisdom_plan_t) + tables.size() * sizeof(okfft_wisdom_table_t);
+
+    for (size_t i = 0; ok && i < tables.size(); i++)
+    {
+        ok = fwrite(zeros, 1, tables[i].offset - pos, f) == tables[i].offset - pos;
+        ok = ok && fwrite(ex.data[i], 1, (size_t) tables[i].size, f) == tables[i].size;
+        pos = (size_t) (tables[i].offset + tables[i].size);
+    }
+
+    return ok && fwrite(zeros, 1, h.size - pos, f) == h.size - pos;
+}
+
+bool okfft_export_plans(const char *path)
+{
+    okfft_wisdom_export_t ex;
+    okfft_cache_for_each(okfft_wisdom_add_plan, &ex);
+
+    // written next to the file and renamed over it, processes that mapped the old one keep their pages
+    char tmp_path[4096];
+    const int tmp_length = snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    bool ok = false;
+    FILE *f = NULL;
+    if (tmp_length < 0 || (size_t) tmp_length >= sizeof(tmp_path))
+        OKFFT_LOG("The path '%s' is too long.\n", path);
+    else if (!(f = fopen(tmp_path, "wb")))
+        OKFFT_LOG("Can't create '%s'.\n", tmp_path);
+    else
+    {
+        ok = okfft_wisdom_write(f, ex);
+        ok = fclose(f) == 0 && ok;
+
+        if (ok)
+            ok = rename(tmp_path, path) == 0;
+        if (!ok)
+        {
+            OKFFT_LOG("Can't write '%s'.\n", path);
+            remove(tmp_path);
+        }
+    }
+
+    for (size_t i = 0; i < ex.held.size(); i++)
+        okfft_release_plan(ex.held[i]);
+
+    return ok;
+}
+
+// IMPORT
+
+#if !defined(_WIN32)
+// the kernels use the tables without any checks, so their sizes and indices are checked once here: a leaf writes
+// 16 floats at each offset and a radix 8 pass of level i reads its factors from 2 * ws_is[i] on. O(N), a lot
+// cheaper than building them.
+static bool okfft_wisdom_check_table(const char *base, const okfft_wisdom_table_t &t)
+{
+    const size_t N = (size_t) t.N;
+    if (N < 8 || N > ((size_t) 1 << 31) || (N & (N - 1)))
+        return false;
+
+    if (t.type == OKFFT_WISDOM_OFFSETS)
+    {
+        if (t.size != N / 8 * sizeof(uint32_t))
+            return false;
+
+        const uint32_t *offsets = (const uint32_t *) (base + t.offset);
+        for (size_t i = 0; i < N / 8; i++)
+        {
+            if (offsets[i] % 16 || offsets[i] > 2 * N - 16)
+                return false;
+        }
+
+        return true;
+    }
+
+    size_t lut_count;
+    const size_t ws_size = okfft_twiddles_size(N, &lut_count);
+
+    if (t.type == OKFFT_WISDOM_TWIDDLES)
+        return t.size == ws_size * sizeof(float);
+
+    if (t.type != OKFFT_WISDOM_TWIDDLE_INDICES || t.size != lut_count * sizeof(ptrdiff_t))
+        return false;
+
+    const ptrdiff_t *ws_is = (const ptrdiff_t *) (base + t.offset);
+    for (size_t i = 0; i < lut_count; i++)
+    {
+        const size_t level_size = i ? (size_t) 48 << (i - 1) : 16;
+        if (ws_is[i] < 0 || (size_t) ws_is[i] > (ws_size - level_size) / 2)
+            return false;
+    }
+
+    return true;
+}
+
+// a key is only imported when the file holds the offsets of the power of two xform its plan runs, so a file can't
+// make the import build plans far larger than its tables. Plans running only small kernels have no offsets, their
+// mixed radix or bluestein parts are limited to the size of the largest table (or 4096 points).
+static bool okfft_wisdom_check_plan(const okfft_wisdom_plan_t &p, const okfft_wisdom_table_t *tables, size_t table_count)
+{
+    if (p.dir > OKFFT_DIR_INVERSE || p.kind > OKFFT_KIND_BIDIR || p.N > ((size_t) 1 << 31))
+        return false;
+
+    const size_t offsets_N = okfft_plan_offsets_N((size_t) p.N, (OKFFT_PLAN_KIND) p.kind);
+    if (!offsets_N)
+        return false;
+
+    size_t max_N = 4096;
+    for (size_t i = 0; i < table_count; i++)
+    {
+        if (offsets_N >= 32 && tables[i].type == OKFFT_WISDOM_OFFSETS && tables[i].N == offsets_N)
+            return true;
+
+        max_N = tables[i].N > max_N ? (size_t) tables[i].N : max_N;
+    }
+
+    return offsets_N < 32 && p.N <= max_N;
+}
+
+static bool okfft_wisdom_check(const char *path, const char *base, size_t size)
+{
+    const okfft_wisdom_header_t *h = (const okfft_wisdom_header_t *) base;
+
+    if (size < sizeof(*h) || memcmp(h->magic, okfft_wisdom_magic, sizeof(h->magic)) != 0)
+    {
+        OKFFT_LOG("'%s' is not a wisdom file.\n", path);
+        return false;
+    }
+
+    if (h->version != OKFFT_WISDOM_VERSION || h->pointer_size != sizeof(ptrdiff_t))
+    {
+        OKFFT_LOG("'%s' is from another version or build (version %u).\n", path, h->version);
+        return false;
+    }
+
+    if (h->size != size)
+    {
+        OKFFT_LOG("'%s' is truncated.\n", path);
+        return false;
+    }
+
+    if (h->isa != (uint32_t) okfft_get_isa())
+    {
+        OKFFT_LOG("'%s' is for kernel set %u, this process uses %u.\n", path, h->isa, (uint32_t) okfft_get_isa());
+        return false;
+    }
+
+    const size_t head = sizeof(*h) + (size_t) h->plan_count * sizeof(okfft_wisdom_plan_t) + (size_t) h->table_count * sizeof(okfft_wisdom_table_t);
+    if (head > size)
+    {
+        OKFFT_LOG("'%s' is truncated.\n", path);
+        return false;
+    }
+
+    const okfft_wisdom_table_t *tables = (const okfft_wisdom_table_t *) (base + sizeof(*h) + h->plan_count * sizeof(okfft_wisdom_plan_t));
+    for (size_t i = 0; i < h->table_count; i++)
+    {
+        if (tables[i].offset % 64 || tables[i].offset < head || tables[i].offset > size || tables[i].size > size - tables[i].offset)
+        {
+            OKFFT_LOG("'%s' has a bad table entry.\n", path);
+            return false;
+        }
+
+        if (!okfft_wisdom_check_table(base, tables[i]))
+        {
+            OKFFT_LOG("'%s' has a bad table (type %u, N %llu).\n", path, tables[i].type, (unsigned long long) tables[i].N);
+            return false;
+        }
+    }
+
+    const okfft_wisdom_plan_t *plans = (const okfft_wisdom_plan_t *) (h + 1);
+    for (size_t i = 0; i < h->plan_count; i++)
+    {
+        if (!okfft_wisdom_check_plan(plans[i], tables, h->table_count))
+        {
+            OKFFT_LOG("'%s' has a bad plan key (N %llu, kind %u) or lacks its tables.\n", path, (unsigned long long) plans[i].N, plans[i].kind);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool okfft_import_plans(const char *path)
+{
+    std::lock_guard<std::mutex> lock(okfft_wisdom_lock);
+
+    const size_t count = okfft_wisdom_map_count.load(std::memory_order_relaxed);
+    if (count == OKFFT_WISDOM_MAPS)
+    {
+        OKFFT_LOG("At most %d wisdom files can be imported.\n", OKFFT_WISDOM_MAPS);
+        return false;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        OKFFT_LOG("Can't open '%s'.\n", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        OKFFT_LOG("'%s' is empty.\n", path);
+        close(fd);
+        return false;
+    }
+
+    const size_t size = (size_t) st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED)
+    {
+        OKFFT_LOG("Can't map '%s'.\n", path);
+        return false;
+    }
+
+    if (!okfft_wisdom_check(path, (const char *) base, size))
+    {
+        munmap(base, size);
+        return false;
+    }
+
+    const okfft_wisdom_header_t *h = (const okfft_wisdom_header_t *) base;
+    const okfft_wisdom_plan_t *plans = (const okfft_wisdom_plan_t *) (h + 1);
+
+    okfft_wisdom_map_t &m = okfft_wisdom_maps[count];
+    m.base = (const char *) base;
+    m.size = size;
+    m.tables = (const okfft_wisdom_table_t *) (plans + h->plan_count);
+    m.table_count = h->table_count;
+    okfft_wisdom_map_count.store(count + 1, std::memory_order_release);
+
+    // the plans are built on the mapped tables, the cache keeps them
+    for (size_t i = 0; i < h->plan_count; i++)
+        okfft_release_plan(okfft_get_plan((size_t) plans[i].N, (OKFFT_DIRECTION) plans[i].dir, (OKFFT_PLAN_KIND) plans[i].kind));
+
+    return true;
+}
+#else
+bool okfft_import_plans(const char *path)
+{
+    OKFFT_LOG("Importing '%s': wisdom files are not supported on this OS.\n", path);
+    return false;
+}
+#endif
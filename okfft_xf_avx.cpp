@@ -385,6 +385,37 @@ void okfft_avx_fwd_generic(const okfft_plan_t *plan, float *__restrict output, c
     _mm256_zeroupper();
 }
 
+// combine passes only of an N point xform (N <= plan->N), for the layout and parallel leaf passes
+void okfft_avx_fwd_passes(const okfft_plan_t *plan, float *__restrict data, size_t N)
+{
+    _mm256_zeroupper();
+    switch (N)
+    {
+    case   32: okfft_avx_xf_fwd_32(plan, data);  break;
+    case   64: okfft_avx_xf_fwd_64(plan, data);  break;
+    case  128: okfft_avx_xf_fwd_128(plan, data); break;
+    case  256: okfft_avx_xf_fwd_256(plan, data); break;
+    case  512: okfft_avx_xf_fwd_512(plan, data); break;
+    case 1024: okfft_avx_xf_fwd_1k(plan, data);  break;
+    case 2048: okfft_avx_xf_fwd_2k(plan, data);  break;
+    case 4096: okfft_avx_xf_fwd_4k(plan, data);  break;
+    case 8192: okfft_avx_xf_fwd_8k(plan, data);  break;
+    default:   okfft_avx_xf_fwd_rec(plan, data, N); break;
+    }
+    _mm256_zeroupper();
+}
+
+// one slice of the radix 8 combine of the N point passes, floats [begin, end) of each of its 8 streams (multiples of 16)
+void okfft_avx_fwd_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end)
+{
+    const __m256 avx_sign_mask = okfft_avx_fwd_sign_mask;
+    const ptrdiff_t *__restrict ws_is = plan->ws_is;
+    const float *__restrict ws = plan->ws;
+    _mm256_zeroupper();
+    OKFFT_AVX_X8_PART(N, data, ws + (ws_is[okfft_avx_ilog2(N) - 4] << 1), begin, end);
+    _mm256_zeroupper();
+}
+
 void okfft_avx_fwd_real(float *__restrict output, float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N)
 {
     _mm256_zeroupper();
@@ -759,6 +790,37 @@ void okfft_avx_inv_generic(const okfft_plan_t *plan, float *__restrict output, c
     _mm256_zeroupper();
 }
 
+// combine passes only of an N point xform (N <= plan->N), for the layout and parallel leaf passes
+void okfft_avx_inv_passes(const okfft_plan_t *plan, float *__restrict data, size_t N)
+{
+    _mm256_zeroupper();
+    switch (N)
+    {
+    case   32: okfft_avx_xf_inv_32(plan, data);  break;
+    case   64: okfft_avx_xf_inv_64(plan, data);  break;
+    case  128: okfft_avx_xf_inv_128(plan, data); break;
+    case  256: okfft_avx_xf_inv_256(plan, data); break;
+    case  512: okfft_avx_xf_inv_512(plan, data); break;
+    case 1024: okfft_avx_xf_inv_1k(plan, data);  break;
+    case 2048: okfft_avx_xf_inv_2k(plan, data);  break;
+    case 4096: okfft_avx_xf_inv_4k(plan, data);  break;
+    case 8192: okfft_avx_xf_inv_8k(plan, data);  break;
+    default:   okfft_avx_xf_inv_rec(plan, data, N); break;
+    }
+    _mm256_zeroupper();
+}
+
+// one slice of the radix 8 combine of the N point passes, floats [begin, end) of each of its 8 streams (multiples of 16)
+void okfft_avx_inv_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end)
+{
+    const __m256 avx_sign_mask = okfft_avx_inv_sign_mask;
+    const ptrdiff_t *__restrict ws_is = plan->ws_is;
+    const float *__restrict ws = plan->ws;
+    _mm256_zeroupper();
+    OKFFT_AVX_X8_PART(N, data, ws + (ws_is[okfft_avx_ilog2(N) - 4] << 1), begin, end);
+    _mm256_zeroupper();
+}
+
 void okfft_avx_inv_real(float *__restrict output, const float *__restrict input, const float *__restrict A, const float *__restrict B, size_t N)
 {
     _mm256_zeroupper();
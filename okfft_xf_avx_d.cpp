@@ -0,0 +1,166 @@
+/*
+This file is part of OKFFT
+
+BSD 3-Clause License
+
+Copyright (c) 2012, 2013, Anthony M. Blake <amb@anthonix.com>
+Copyright (c) 2012, The University of Waikato
+Copyright (c) 2015, Jukka Ojanen <jukka.ojanen@kolumbus.fi>
+Copyright (c) 2017, Espen Andreassen <espandre@gmail.com>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+* Neither the name of the organization nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ANTHONY M. BLAKE BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "okfft.h"
+
+#ifdef OKFFT_HAS_AVX
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+    #define okfft_force_inline __forceinline
+    #define OKFFT_ALIGN(x) __declspec(align(x))
+#else
+    #include <x86intrin.h>
+    #define okfft_force_inline inline __attribute__((always_inline))
+    #define OKFFT_ALIGN(x) __attribute__((aligned(x)))
+#endif
+
+// a ymm of doubles holds two complex values, one per 128 bit lane
+typedef __m256d okfft_vd;
+
+#define okfft_vd_load(p)         _mm256_load_pd(p)
+#define okfft_vd_loadu(p)        _mm256_loadu_pd(p)
+#define okfft_vd_store(p, x)     _mm256_store_pd(p, x)
+#define okfft_vd_add(x, y)       _mm256_add_pd(x, y)
+#define okfft_vd_sub(x, y)       _mm256_sub_pd(x, y)
+#define okfft_vd_mul(x, y)       _mm256_mul_pd(x, y)
+#define okfft_vd_swap_pairs(x)   _mm256_permute_pd(x, 0x5)
+#define okfft_vd_swap_sign(x)    _mm256_xor_pd(x, vd_sign_mask)
+#define okfft_vd_unpack_lo(x, y) _mm256_permute2f128_pd(x, y, 0x20)
+#define okfft_vd_unpack_hi(x, y) _mm256_permute2f128_pd(x, y, 0x31)
+#define okfft_vd_blend(x, y)     _mm256_blend_pd(x, y, 0xc)
+
+#include "okfft_macros_d.h"
+
+#define OKFFT_SQRT_HALF_D 0.7071067811865475244008443621048490392848359376884740
+
+static const OKFFT_ALIGN(32) double okfft_avx_d_inv_constants[16] =
+{
+    OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+    OKFFT_SQRT_HALF_D,  -OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,  -OKFFT_SQRT_HALF_D,
+    1.0,                 1.0,                 OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+    0.0,                 0.0,                 OKFFT_SQRT_HALF_D,  -OKFFT_SQRT_HALF_D,
+};
+
+static const OKFFT_ALIGN(32) double okfft_avx_d_fwd_constants[16] =
+{
+     OKFFT_SQRT_HALF_D,  OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+    -OKFFT_SQRT_HALF_D,  OKFFT_SQRT_HALF_D,  -OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+     1.0,                1.0,                 OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+     0.0,                0.0,                -OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+};
+
+// plain arrays, a static __m256d would need a dynamic initializer running AVX code at load
+static const OKFFT_ALIGN(32) double okfft_avx_d_fwd_sign[4] = { 0.0, -0.0, 0.0, -0.0 };
+static const OKFFT_ALIGN(32) double okfft_avx_d_inv_sign[4] = { -0.0, 0.0, -0.0, 0.0 };
+
+static okfft_force_inline size_t okfft_avx_d_ilog2(size_t N)
+{
+#ifdef _MSC_VER
+    unsigned long l2;
+    _BitScanForward64(&l2, N);
+    return l2;
+#else
+    return __builtin_ctzll(N);
+#endif
+}
+
+// split radix recursion of the unrolled float kernels, N / 4, N / 8, N / 8, N / 4, N / 4 and an X8 pass to join them
+static void okfft_avx_d_xf_rec(const okfft_plan_d_t *plan, double *__restrict data, size_t N, const okfft_vd vd_sign_mask)
+{
+    const ptrdiff_t *__restrict ws_is = plan->ws_is;
+    const double *__restrict ws = plan->ws;
+
+    if (N == 16)
+    {
+        OKFFT_VD_X4(data, ws);
+    }
+    else if (N >= 32)
+    {
+        if (N > 32)
+        {
+            size_t N2 = N >> 1;
+            size_t N4 = N >> 2;
+            size_t N8 = N >> 3;
+
+            okfft_avx_d_xf_rec(plan, data, N4, vd_sign_mask);
+            okfft_avx_d_xf_rec(plan, data + N2, N8, vd_sign_mask);
+            okfft_avx_d_xf_rec(plan, data + N2 + N4, N8, vd_sign_mask);
+            okfft_avx_d_xf_rec(plan, data + N, N4, vd_sign_mask);
+            okfft_avx_d_xf_rec(plan, data + N + N2, N4, vd_sign_mask);
+        }
+
+        OKFFT_VD_X8(N, data, ws + (ws_is[okfft_avx_d_ilog2(N) - 4] << 1));
+    }
+}
+
+void okfft_avx_d_fwd(const okfft_plan_d_t *plan, double *__restrict output, const double *__restrict input)
+{
+    const okfft_vd vd_sign_mask = _mm256_load_pd(okfft_avx_d_fwd_sign);
+    const double *__restrict vd_constants = okfft_avx_d_fwd_constants;
+    size_t i0 = plan->i0, i1 = plan->i1;
+    if (okfft_avx_d_ilog2(plan->N) & 1) // check if ilog2(N) is odd
+    {
+        OKFFT_VD_FP_ODD(i0, i1, plan, output, input)
+    }
+    else
+    {
+        OKFFT_VD_FP_EVEN(i0, i1, plan, output, input)
+    }
+
+    okfft_avx_d_xf_rec(plan, output, plan->N, vd_sign_mask);
+}
+
+void okfft_avx_d_inv(const okfft_plan_d_t *plan, double *__restrict output, const double *__restrict input)
+{
+    const okfft_vd vd_sign_mask = _mm256_load_pd(okfft_avx_d_inv_sign);
+    const double *__restrict vd_constants = okfft_avx_d_inv_constants;
+    size_t i0 = plan->i0, i1 = plan->i1;
+    if (okfft_avx_d_ilog2(plan->N) & 1) // check if ilog2(N) is odd
+    {
+        OKFFT_VD_FP_ODD(i0, i1, plan, output, input)
+    }
+    else
+    {
+        OKFFT_VD_FP_EVEN(i0, i1, plan, output, input)
+    }
+
+    okfft_avx_d_xf_rec(plan, output, plan->N, vd_sign_mask);
+}
+
+#endif
@@ -0,0 +1,802 @@
+/*
+This file is part of OKFFT
+
+BSD 3-Clause License
+
+Copyright (c) 2012, 2013, Anthony M. Blake <amb@anthonix.com>
+Copyright (c) 2012, The University of Waikato
+Copyright (c) 2015, Jukka Ojanen <jukka.ojanen@kolumbus.fi>
+Copyright (c) 2017, Espen Andreassen <espandre@gmail.com>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+* Neither the name of the organization nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ANTHONY M. BLAKE BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "okfft.h"
+#include <string.h>
+
+// the leafs load their two complex values through a loader (strided / split), which folds the input gather into the leaf pass
+#define okfft_sse_load_leaf(p) ld.load(p)
+
+#include "okfft_macros.h"
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+    #define okfft_force_inline __forceinline
+    #define OKFFT_ALIGN(x) __declspec(align(x))
+#else
+    #include <x86intrin.h>
+    #define okfft_force_inline inline __attribute__((always_inline))
+    #define OKFFT_ALIGN(x) __attribute__((aligned(x)))
+#endif
+
+// Xforms for non contiguous input / output layouts (strided, split complex). The leafs run with the sse macros
+// (the leaf output is the same for every kernel set) and are followed by the combine passes of the plan's kernel
+// set. Sizes without combine passes (small, mixed radix, bluestein) gather into / scatter from a per thread scratch buffer.
+
+// columns per tile of the 2d / 3d column passes (two 64 byte lines per row), narrowed to keep a tile
+// and its xformed copy within 'OKFFT_LAYOUT_TILE_BYTES' (~ L2)
+#define OKFFT_LAYOUT_TILE 16
+#define OKFFT_LAYOUT_TILE_BYTES (256 * 1024)
+
+// floats rounded up to whole 64 byte lines
+#define OKFFT_LAYOUT_PAD(n) (((n) + 15) & ~(size_t) 15)
+
+// leafs / lines ahead of the in place passes
+#define OKFFT_LAYOUT_PREFETCH_LEAFS 16
+#define OKFFT_LAYOUT_PREFETCH_LINES 16
+
+// rows ahead of the tile gathers / scatters
+#define OKFFT_LAYOUT_PREFETCH_ROWS 16
+
+#define OKFFT_SQRT_HALF 0.7071067811865475244008443621048490392848359376884740f
+
+static const OKFFT_ALIGN(16) float okfft_sse_inv_constants[16] =
+{
+    OKFFT_SQRT_HALF,     OKFFT_SQRT_HALF,   OKFFT_SQRT_HALF,     OKFFT_SQRT_HALF,
+    OKFFT_SQRT_HALF,    -OKFFT_SQRT_HALF,   OKFFT_SQRT_HALF,    -OKFFT_SQRT_HALF,
+    1.0f,                1.0f,              OKFFT_SQRT_HALF,     OKFFT_SQRT_HALF,
+    0.0f,                0.0f,              OKFFT_SQRT_HALF,    -OKFFT_SQRT_HALF,
+};
+
+static const OKFFT_ALIGN(16) float okfft_sse_fwd_constants[16] =
+{
+     OKFFT_SQRT_HALF,    OKFFT_SQRT_HALF,    OKFFT_SQRT_HALF,   OKFFT_SQRT_HALF,
+    -OKFFT_SQRT_HALF,    OKFFT_SQRT_HALF,   -OKFFT_SQRT_HALF,   OKFFT_SQRT_HALF,
+     1.0f,               1.0f,               OKFFT_SQRT_HALF,   OKFFT_SQRT_HALF,
+     0.0f,               0.0f,              -OKFFT_SQRT_HALF,   OKFFT_SQRT_HALF,
+};
+
+static const __m128 okfft_sse_fwd_sign_mask = _mm_set_ps(-0.f, 0.f, -0.f, 0.f);
+static const __m128 okfft_sse_inv_sign_mask = _mm_set_ps(0.f, -0.f, 0.f, -0.f);
+
+// per thread scratch (okfft.cpp)
+float *okfft_thread_scratch(size_t slot, size_t size);
+
+static okfft_force_inline size_t okfft_layout_ilog2(size_t N)
+{
+#ifdef _MSC_VER
+    unsigned long l2;
+    _BitScanReverse64(&l2, N);
+    return l2;
+#else
+    return __builtin_ctzll(N);
+#endif
+}
+
+// two complex values 'step' floats apart
+struct okfft_layout_strided_loader
+{
+    ptrdiff_t step;
+
+    okfft_force_inline __m128 load(const float *p) const
+    {
+        __m128 lo = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) p);
+        return _mm_loadh_pi(lo, (const __m64 *) (p + step));
+    }
+};
+
+// two consecutive complex values, the layout of the regular leafs
+struct okfft_layout_contig_loader
+{
+    okfft_force_inline __m128 load(const float *p) const
+    {
+        return _mm_load_ps(p);
+    }
+};
+
+// two complex values from the split arrays, 'p' points into 're'
+struct okfft_layout_split_loader
+{
+    const float *re, *im;
+
+    okfft_force_inline __m128 load(const float *p) const
+    {
+        __m128 r = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) p);
+        __m128 i = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) (im + (p - re)));
+        return _mm_unpacklo_ps(r, i);
+    }
+};
+
+// complex values are moved as one 64 bit word
+static void okfft_layout_gather(float *__restrict out, const float *__restrict in, size_t N, size_t stride)
+{
+    const uint64_t *__restrict src = (const uint64_t *) in;
+    uint64_t *__restrict dst = (uint64_t *) out;
+
+    for (size_t i = 0; i < N; i++)
+        dst[i] = src[i * stride];
+}
+
+static void okfft_layout_scatter(float *__restrict out, const float *__restrict in, size_t N, size_t stride)
+{
+    const uint64_t *__restrict src = (const uint64_t *) in;
+    uint64_t *__restrict dst = (uint64_t *) out;
+
+    for (size_t i = 0; i < N; i++)
+        dst[i * stride] = src[i];
+}
+
+static void okfft_layout_interleave(float *__restrict out, const float *__restrict re, const float *__restrict im, size_t N)
+{
+    size_t i = 0;
+    for (; i + 4 <= N; i += 4)
+    {
+        __m128 r = _mm_loadu_ps(re + i);
+        __m128 m = _mm_loadu_ps(im + i);
+        _mm_storeu_ps(out + 2 * i + 0, _mm_unpacklo_ps(r, m));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(r, m));
+    }
+
+    for (; i < N; i++)
+    {
+        out[2 * i + 0] = re[i];
+        out[2 * i + 1] = im[i];
+    }
+}
+
+static void okfft_layout_deinterleave(float *__restrict re, float *__restrict im, const float *__restrict in, size_t N)
+{
+    size_t i = 0;
+    for (; i + 4 <= N; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(in + 2 * i + 0);
+        __m128 b = _mm_loadu_ps(in + 2 * i + 4);
+        _mm_storeu_ps(re + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(im + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+
+    for (; i < N; i++)
+    {
+        re[i] = in[2 * i + 0];
+        im[i] = in[2 * i + 1];
+    }
+}
+
+// leafs [begin, end) of the leaf pass of 'OKFFT_SSE_FP_EVEN / ODD' with the leaf loads of 'ld', 'is' are the input
+// indices and 'step' the input advance per leaf, both in floats of the array 'in' points to
+template <typename L>
+static okfft_force_inline void okfft_layout_leaf_range(const okfft_plan_t *plan, const L &ld, float *__restrict out, const float *__restrict in, const ptrdiff_t *__restrict is, const ptrdiff_t step, size_t begin, size_t end, const __m128 sse_sign_mask, const float *__restrict sse_constants)
+{
+    const uint32_t *__restrict os = plan->offsets + 2 * begin;
+    const size_t i0 = plan->i0, i1 = plan->i1;
+    size_t j = begin;
+
+    in += begin * step;
+
+    for (; j < end && j < i0; j++)
+    {
+        OKFFT_SSE_LEAF_EE(out, os, in, is);
+        in += step;
+        os += 2;
+    }
+
+    if (okfft_layout_ilog2(plan->N) & 1) // check if ilog2(N) is odd
+    {
+        for (; j < end && j < i0 + i1; j++)
+        {
+            OKFFT_SSE_LEAF_OO(out, os, in, is);
+            in += step;
+            os += 2;
+        }
+
+        if (j < end && j == i0 + i1)
+        {
+            OKFFT_SSE_LEAF_OE(out, os, in, is);
+            in += step;
+            os += 2;
+            j++;
+        }
+    }
+    else
+    {
+        if (j < end && j == i0)
+        {
+            OKFFT_SSE_LEAF_EO(out, os, in, is);
+            in += step;
+            os += 2;
+            j++;
+        }
+
+        for (; j < end && j < i0 + 1 + i1; j++)
+        {
+            OKFFT_SSE_LEAF_OO(out, os, in, is);
+            in += step;
+            os += 2;
+        }
+    }
+
+    for (; j < end; j++)
+    {
+        OKFFT_SSE_LEAF_EE2(out, os, in, is);
+        in += step;
+        os += 2;
+    }
+}
+
+// the whole leaf pass, N / 16 leafs
+template <typename L>
+static okfft_force_inline void okfft_layout_leafs(const okfft_plan_t *plan, const L &ld, float *__restrict out, const float *__restrict in, const ptrdiff_t *__restrict is, const ptrdiff_t step, const __m128 sse_sign_mask, const float *__restrict sse_constants)
+{
+    okfft_layout_leaf_range(plan, ld, out, in, is, step, 0, plan->N / 16, sse_sign_mask, sse_constants);
+}
+
+// leaf inputs of the in place leaf pass are its two output blocks, the blocks of a later leaf are prefetched
+// as they are all over the buffer ('os_end' is the end of the offsets)
+static okfft_force_inline void okfft_layout_inplace_is(ptrdiff_t *__restrict is, const float *data, const uint32_t *__restrict os, const uint32_t *__restrict os_end)
+{
+    for (size_t i = 0; i < 4; i++)
+    {
+        is[i + 0] = os[0] + 4 * i;
+        is[i + 4] = os[1] + 4 * i;
+    }
+
+    if (os + 2 * OKFFT_LAYOUT_PREFETCH_LEAFS < os_end)
+    {
+        _mm_prefetch((const char *) (data + os[2 * OKFFT_LAYOUT_PREFETCH_LEAFS + 0]), _MM_HINT_T0);
+        _mm_prefetch((const char *) (data + os[2 * OKFFT_LAYOUT_PREFETCH_LEAFS + 1]), _MM_HINT_T0);
+    }
+}
+
+// the leaf pass of 'OKFFT_SSE_FP_EVEN / ODD' for data permuted by 'okfft_layout_inplace_permute',
+// every leaf reads its inputs where it writes its outputs (the leafs load everything before storing)
+static okfft_force_inline void okfft_layout_inplace_leafs(const okfft_plan_t *plan, float *data, const __m128 sse_sign_mask, const float *__restrict sse_constants)
+{
+    const okfft_layout_contig_loader ld = {};
+    const uint32_t *__restrict os = plan->offsets;
+    const uint32_t *__restrict os_end = os + plan->N / 8;
+    const size_t i0 = plan->i0, i1 = plan->i1;
+    ptrdiff_t is[8];
+
+    for (size_t i = i0; i > 0; --i)
+    {
+        okfft_layout_inplace_is(is, data, os, os_end);
+        OKFFT_SSE_LEAF_EE(data, os, data, is);
+        os += 2;
+    }
+
+    if (okfft_layout_ilog2(plan->N) & 1) // check if ilog2(N) is odd
+    {
+        for (size_t i = i1; i > 0; --i)
+        {
+            okfft_layout_inplace_is(is, data, os, os_end);
+            OKFFT_SSE_LEAF_OO(data, os, data, is);
+            os += 2;
+        }
+
+        okfft_layout_inplace_is(is, data, os, os_end);
+        OKFFT_SSE_LEAF_OE(data, os, data, is);
+        os += 2;
+    }
+    else
+    {
+        okfft_layout_inplace_is(is, data, os, os_end);
+        OKFFT_SSE_LEAF_EO(data, os, data, is);
+        os += 2;
+
+        for (size_t i = i1; i > 0; --i)
+        {
+            okfft_layout_inplace_is(is, data, os, os_end);
+            OKFFT_SSE_LEAF_OO(data, os, data, is);
+            os += 2;
+        }
+    }
+
+    for (size_t i = i1; i > 0; --i)
+    {
+        okfft_layout_inplace_is(is, data, os, os_end);
+        OKFFT_SSE_LEAF_EE2(data, os, data, is);
+        os += 2;
+    }
+}
+
+// moves the leaf inputs where the leafs write their outputs, see 'okfft_init_inplace_cycles'
+static void okfft_layout_inplace_permute(const okfft_plan_t *plan, float *data)
+{
+    const size_t N = plan->N;
+    const ptrdiff_t *is = plan->is;
+
+    // the 8 lines holding the inputs of 4 leafs: line k has input k of every leaf, afterwards line 2c + h
+    // has inputs 4h .. 4h + 3 of leaf c
+    for (size_t t = 0; t < N / 64; t++)
+    {
+        __m128 v[8][4];
+
+        for (size_t k = 0; k < 8; k++)
+            for (size_t c = 0; c < 4; c++)
+                v[k][c] = _mm_load_ps(data + is[k] + 16 * t + 4 * c);
+
+        for (size_t k = 0; k < 8; k++)
+            for (size_t q = 0; q < 4; q++)
+                _mm_store_ps(data + is[k] + 16 * t + 4 * q, v[4 * (k % 2) + q][k / 2]);
+    }
+
+    // whole lines along the cycles, the next lines are prefetched as they are all over the buffer
+    const uint32_t *__restrict cycles = plan->ip_cycles;
+    const uint32_t *__restrict end = cycles + plan->ip_cycles_size;
+
+    while (cycles < end)
+    {
+        const size_t length = cycles[0];
+        const uint32_t *__restrict lines = cycles + 1;
+
+        float *line = data + 16 * (size_t) lines[0];
+        __m128 c0 = _mm_load_ps(line + 0);
+        __m128 c1 = _mm_load_ps(line + 4);
+        __m128 c2 = _mm_load_ps(line + 8);
+        __m128 c3 = _mm_load_ps(line + 12);
+
+        for (size_t i = 1; i < length; i++)
+        {
+            if (i + OKFFT_LAYOUT_PREFETCH_LINES < length)
+                _mm_prefetch((const char *) (data + 16 * (size_t) lines[i + OKFFT_LAYOUT_PREFETCH_LINES]), _MM_HINT_T0);
+
+            float *next = data + 16 * (size_t) lines[i];
+            __m128 n0 = _mm_load_ps(next + 0);
+            __m128 n1 = _mm_load_ps(next + 4);
+            __m128 n2 = _mm_load_ps(next + 8);
+            __m128 n3 = _mm_load_ps(next + 12);
+
+            _mm_store_ps(next + 0, c0);
+            _mm_store_ps(next + 4, c1);
+            _mm_store_ps(next + 8, c2);
+            _mm_store_ps(next + 12, c3);
+
+            c0 = n0; c1 = n1; c2 = n2; c3 = n3;
+        }
+
+        _mm_store_ps(line + 0, c0);
+        _mm_store_ps(line + 4, c1);
+        _mm_store_ps(line + 8, c2);
+        _mm_store_ps(line + 12, c3);
+
+        cycles += 1 + length;
+    }
+}
+
+static okfft_force_inline void okfft_layout_strided(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input, const __m128 sse_sign_mask, const float *__restrict sse_constants)
+{
+    const size_t N = plan->N;
+    const bool contiguous_out = plan->ostride == 1;
+
+    if (plan->passes)
+    {
+        float *__restrict data = contiguous_out ? output : okfft_thread_scratch(OKFFT_SCRATCH_LAYOUT, 2 * N);
+
+        const ptrdiff_t stride = (ptrdiff_t) plan->istride;
+        const okfft_layout_strided_loader ld = { 2 * stride };
+
+        ptrdiff_t is[8];
+        for (size_t i = 0; i < 8; i++)
+            is[i] = plan->is[i] * stride;
+
+        okfft_layout_leafs(plan, ld, data, input, is, 4 * stride, sse_sign_mask, sse_constants);
+        plan->passes(plan, data, N);
+
+        if (!contiguous_out)
+            okfft_layout_scatter(output, data, N, plan->ostride);
+    }
+    else
+    {
+        float *__restrict in = okfft_thread_scratch(OKFFT_SCRATCH_LAYOUT, 4 * N);
+        float *__restrict out = contiguous_out ? output : in + 2 * N;
+
+        okfft_layout_gather(in, input, N, plan->istride);
+        plan->xform_contig(plan, out, in);
+
+        if (!contiguous_out)
+            okfft_layout_scatter(output, out, N, plan->ostride);
+    }
+}
+
+void okfft_layout_strided_fwd(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    okfft_layout_strided(plan, output, input, okfft_sse_fwd_sign_mask, okfft_sse_fwd_constants);
+}
+
+void okfft_layout_strided_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    okfft_layout_strided(plan, output, input, okfft_sse_inv_sign_mask, okfft_sse_inv_constants);
+}
+
+static okfft_force_inline void okfft_layout_split(const okfft_plan_t *plan, float *__restrict out_re, float *__restrict out_im, const float *__restrict in_re, const float *__restrict in_im, const __m128 sse_sign_mask, const float *__restrict sse_constants)
+{
+    const size_t N = plan->N;
+
+    if (plan->passes)
+    {
+        // the combine passes run in place on interleaved data, the output is split while it is still in cache
+        float *__restrict data = okfft_thread_scratch(OKFFT_SCRATCH_LAYOUT, 2 * N);
+        const okfft_layout_split_loader ld = { in_re, in_im };
+
+        ptrdiff_t is[8];
+        for (size_t i = 0; i < 8; i++)
+            is[i] = plan->is[i] / 2;
+
+        okfft_layout_leafs(plan, ld, data, in_re, is, 2, sse_sign_mask, sse_constants);
+        plan->passes(plan, data, N);
+        okfft_layout_deinterleave(out_re, out_im, data, N);
+    }
+    else
+    {
+        float *__restrict in = okfft_thread_scratch(OKFFT_SCRATCH_LAYOUT, 4 * N);
+        float *__restrict out = in + 2 * N;
+
+        okfft_layout_interleave(in, in_re, in_im, N);
+        plan->xform_contig(plan, out, in);
+        okfft_layout_deinterleave(out_re, out_im, out, N);
+    }
+}
+
+void okfft_layout_split_fwd(const okfft_plan_t *plan, float *__restrict out_re, float *__restrict out_im, const float *__restrict in_re, const float *__restrict in_im)
+{
+    okfft_layout_split(plan, out_re, out_im, in_re, in_im, okfft_sse_fwd_sign_mask, okfft_sse_fwd_constants);
+}
+
+void okfft_layout_split_inv(const okfft_plan_t *plan, float *__restrict out_re, float *__restrict out_im, const float *__restrict in_re, const float *__restrict in_im)
+{
+    okfft_layout_split(plan, out_re, out_im, in_re, in_im, okfft_sse_inv_sign_mask, okfft_sse_inv_constants);
+}
+
+static okfft_force_inline void okfft_layout_inplace(const okfft_plan_t *plan, float *output, const float *input, const __m128 sse_sign_mask, const float *__restrict sse_constants)
+{
+    if (output != input)
+    {
+        plan->xform_contig(plan, output, input);
+    }
+    else if (plan->ip_cycles)
+    {
+        okfft_layout_inplace_permute(plan, output);
+        okfft_layout_inplace_leafs(plan, output, sse_sign_mask, sse_constants);
+        plan->passes(plan, output, plan->N);
+    }
+    else
+    {
+        float *__restrict in = okfft_thread_scratch(OKFFT_SCRATCH_LAYOUT, 2 * plan->N);
+        memcpy(in, input, 2 * plan->N * sizeof(float));
+        plan->xform_contig(plan, output, in);
+    }
+}
+
+// no __restrict, 'output == input' is the point
+void okfft_layout_inplace_fwd(const okfft_plan_t *plan, float *output, const float *input)
+{
+    okfft_layout_inplace(plan, output, input, okfft_sse_fwd_sign_mask, okfft_sse_fwd_constants);
+}
+
+void okfft_layout_inplace_inv(const okfft_plan_t *plan, float *output, const float *input)
+{
+    okfft_layout_inplace(plan, output, input, okfft_sse_inv_sign_mask, okfft_sse_inv_constants);
+}
+
+// data[k] <-> data[N - k] for 0 < k < N. For N % 4 == 0 with aligned vectors only: the new vector at k (k even, k < N / 2)
+// is the lo half of the old one at N - k and the hi half of the old one at N - k - 2, the one at N - k - 2 gets the
+// lo half of the old one at k + 2 and the hi half of the old one at k.
+static void okfft_layout_reverse(float *data, size_t N)
+{
+    if (N & 3)
+    {
+        for (size_t i = 1, j = N - 1; i < j; i++, j--)
+        {
+            __m128 f = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) (data + 2 * i));
+            __m128 b = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) (data + 2 * j));
+            _mm_storel_pi((__m64 *) (data + 2 * i), b);
+            _mm_storel_pi((__m64 *) (data + 2 * j), f);
+        }
+
+        return;
+    }
+
+    __m128 f = _mm_load_ps(data);
+    __m128 g_prev = f; // data[N] is data[0]
+
+    for (size_t k = 0; k < N / 2; k += 2)
+    {
+        __m128 g = _mm_load_ps(data + 2 * (N - k - 2));
+        __m128 f_next = _mm_load_ps(data + 2 * (k + 2));
+
+        _mm_store_ps(data + 2 * k, _mm_shuffle_ps(g_prev, g, _MM_SHUFFLE(3, 2, 1, 0)));
+        _mm_store_ps(data + 2 * (N - k - 2), _mm_shuffle_ps(f_next, f, _MM_SHUFFLE(3, 2, 1, 0)));
+
+        f = f_next;
+        g_prev = g;
+    }
+}
+
+// the inverse of a bidirectional plan through its forward tables: ifft(x)[k] = fft(x)[N - k], so the regular
+// forward xform followed by reversing all but the first output
+void okfft_layout_bidir_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    plan->xform_contig(plan, output, input);
+    okfft_layout_reverse(output, plan->N);
+}
+
+// leafs [begin, end) of the unit stride leaf pass, for the parallel xforms (okfft_threads.cpp)
+void okfft_layout_leafs_fwd(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input, size_t begin, size_t end)
+{
+    const okfft_layout_contig_loader ld = {};
+    okfft_layout_leaf_range(plan, ld, output, input, plan->is, 4, begin, end, okfft_sse_fwd_sign_mask, okfft_sse_fwd_constants);
+}
+
+void okfft_layout_leafs_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input, size_t begin, size_t end)
+{
+    const okfft_layout_contig_loader ld = {};
+    okfft_layout_leaf_range(plan, ld, output, input, plan->is, 4, begin, end, okfft_sse_inv_sign_mask, okfft_sse_inv_constants);
+}
+
+// the 'w' columns of two rows at 'p' (a few rows ahead of the tile gather / scatter), rows far apart are on
+// different pages and the hardware prefetchers don't follow them
+static okfft_force_inline void okfft_layout_prefetch_rows(const float *p, size_t ld, size_t w)
+{
+    for (size_t c = 0; c < 2 * w; c += 16)
+    {
+        _mm_prefetch((const char *) (p + c), _MM_HINT_T0);
+        _mm_prefetch((const char *) (p + 2 * ld + c), _MM_HINT_T0);
+    }
+}
+
+// 'w' columns of 'rows' values from the row major 'in' (row length 'ld' complex) into consecutive columns of 'out',
+// 2 x 2 complex blocks at a time (rows is even, an odd last column is moved 2 x 1). Rows of the half spectrum
+// of real xforms aren't 16 byte aligned, so the matrix side uses unaligned accesses. Also used by okfft_ooc.cpp.
+void okfft_layout_tile_gather(float *__restrict out, const float *__restrict in, size_t rows, size_t ld, size_t w)
+{
+    for (size_t r = 0; r < rows; r += 2)
+    {
+        const float *__restrict r0 = in + 2 * ld * r;
+        const float *__restrict r1 = r0 + 2 * ld;
+
+        okfft_layout_prefetch_rows(r0 + 2 * ld * OKFFT_LAYOUT_PREFETCH_ROWS, ld, w);
+
+        size_t c = 0;
+        for (; c + 2 <= w; c += 2)
+        {
+            __m128 a = _mm_loadu_ps(r0 + 2 * c);
+            __m128 b = _mm_loadu_ps(r1 + 2 * c);
+            _mm_store_ps(out + 2 * rows * (c + 0) + 2 * r, _mm_movelh_ps(a, b));
+            _mm_store_ps(out + 2 * rows * (c + 1) + 2 * r, _mm_movehl_ps(b, a));
+        }
+
+        if (c < w)
+        {
+            __m128 a = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) (r0 + 2 * c));
+            _mm_store_ps(out + 2 * rows * c + 2 * r, _mm_loadh_pi(a, (const __m64 *) (r1 + 2 * c)));
+        }
+    }
+}
+
+void okfft_layout_tile_scatter(float *__restrict out, const float *__restrict in, size_t rows, size_t ld, size_t w)
+{
+    for (size_t r = 0; r < rows; r += 2)
+    {
+        float *__restrict r0 = out + 2 * ld * r;
+        float *__restrict r1 = r0 + 2 * ld;
+
+        okfft_layout_prefetch_rows(r0 + 2 * ld * OKFFT_LAYOUT_PREFETCH_ROWS, ld, w);
+
+        size_t c = 0;
+        for (; c + 2 <= w; c += 2)
+        {
+            __m128 a = _mm_load_ps(in + 2 * rows * (c + 0) + 2 * r);
+            __m128 b = _mm_load_ps(in + 2 * rows * (c + 1) + 2 * r);
+            _mm_storeu_ps(r0 + 2 * c, _mm_movelh_ps(a, b));
+            _mm_storeu_ps(r1 + 2 * c, _mm_movehl_ps(b, a));
+        }
+
+        if (c < w)
+        {
+            __m128 a = _mm_load_ps(in + 2 * rows * c + 2 * r);
+            _mm_storel_pi((__m64 *) (r0 + 2 * c), a);
+            _mm_storeh_pi((__m64 *) (r1 + 2 * c), a);
+        }
+    }
+}
+
+// xforms along the first 'width' columns of the row major 'rows' x 'ld' matrix 'in' into the same columns of
+// 'out' (row length 'ld_out', may be 'in'), a tile of columns at a time: gathered into scratch, transformed there
+// and scattered back, so every row access is a whole line and the column xforms run on contiguous data. The tile
+// is narrowed for tall matrices to keep both scratch halves within L2.
+static size_t okfft_layout_tile_width(size_t rows, size_t width)
+{
+    size_t tile = OKFFT_LAYOUT_TILE;
+    while (tile > 2 && (tile >= 2 * width || 16 * rows * tile > OKFFT_LAYOUT_TILE_BYTES))
+        tile /= 2;
+
+    return tile;
+}
+
+static void okfft_layout_columns(const okfft_plan_t *col_plan, float *out, size_t ld_out, const float *in, size_t ld, size_t rows, size_t width)
+{
+    const size_t tile = okfft_layout_tile_width(rows, width);
+
+    float *__restrict a = okfft_thread_scratch(OKFFT_SCRATCH_LAYOUT, 4 * rows * tile);
+    float *__restrict b = a + 2 * rows * tile;
+
+    for (size_t c = 0; c < width; c += tile)
+    {
+        const size_t w = width - c < tile ? width - c : tile;
+
+        okfft_layout_tile_gather(a, in + 2 * c, rows, ld, w);
+
+        for (size_t i = 0; i < w; i++)
+            col_plan->xform(col_plan, b + 2 * rows * i, a + 2 * rows * i);
+
+        okfft_layout_tile_scatter(out + 2 * c, b, rows, ld_out, w);
+    }
+}
+
+// rows straight into the output, then the columns
+void okfft_layout_2d(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    const size_t rows = plan->dims[0], cols = plan->dims[1];
+    const okfft_plan_t *row_plan = plan->dim_plans[1];
+
+    for (size_t r = 0; r < rows; r++)
+        row_plan->xform(row_plan, output + 2 * cols * r, input + 2 * cols * r);
+
+    okfft_layout_columns(plan->dim_plans[0], output, cols, output, cols, rows, cols);
+}
+
+// rows straight into the output, the columns of every d0 slab, then the d0 pencils as the columns of
+// the d0 x (d1 * d2) matrix
+void okfft_layout_3d(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    const size_t d0 = plan->dims[0], d1 = plan->dims[1], d2 = plan->dims[2];
+    const okfft_plan_t *row_plan = plan->dim_plans[2];
+
+    for (size_t r = 0; r < d0 * d1; r++)
+        row_plan->xform(row_plan, output + 2 * d2 * r, input + 2 * d2 * r);
+
+    for (size_t i = 0; i < d0; i++)
+    {
+        float *slab = output + 2 * d1 * d2 * i;
+        okfft_layout_columns(plan->dim_plans[1], slab, d2, slab, d2, d1, d2);
+    }
+
+    okfft_layout_columns(plan->dim_plans[0], output, d1 * d2, output, d1 * d2, d0, d1 * d2);
+}
+
+// real 2d, the rows x (cols / 2 + 1) half spectrum. The real row xforms want aligned rows, so they go
+// through a row buffer (forward) or a padded copy of the spectrum (inverse).
+void okfft_layout_real_2d_fwd(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    const size_t rows = plan->dims[0], cols = plan->dims[1], half = cols / 2 + 1;
+    const okfft_plan_t *row_plan = plan->dim_plans[1];
+
+    okfft_buffer_t state = { okfft_thread_scratch(OKFFT_SCRATCH_ROWS, 2 * OKFFT_LAYOUT_PAD(cols + 2)) };
+    float *__restrict row = state.buffer + OKFFT_LAYOUT_PAD(cols + 2);
+
+    for (size_t r = 0; r < rows; r++)
+    {
+        okfft_execute_real(row_plan, &state, row, input + cols * r);
+        memcpy(output + 2 * half * r, row, 2 * half * sizeof(float));
+    }
+
+    okfft_layout_columns(plan->dim_plans[0], output, half, output, half, rows, half);
+}
+
+void okfft_layout_real_2d_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    const size_t rows = plan->dims[0], cols = plan->dims[1], half = cols / 2 + 1;
+    const size_t ld = OKFFT_LAYOUT_PAD(cols + 2) / 2;
+    const okfft_plan_t *row_plan = plan->dim_plans[1];
+
+    float *__restrict spectrum = okfft_thread_scratch(OKFFT_SCRATCH_ROWS, 2 * ld * (rows + 1));
+    okfft_buffer_t state = { spectrum + 2 * ld * rows };
+
+    okfft_layout_columns(plan->dim_plans[0], spectrum, ld, input, half, rows, half);
+
+    for (size_t r = 0; r < rows; r++)
+        okfft_execute_real(row_plan, &state, output + cols * r, spectrum + 2 * ld * r);
+}
+
+// x * w for two interleaved complex values
+static okfft_force_inline __m128 okfft_layout_cmul(__m128 x, __m128 w)
+{
+    const __m128 sign = _mm_set_ps(0.f, -0.f, 0.f, -0.f);
+    __m128 wr = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 wi = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128 xi = _mm_xor_ps(_mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)), wi), sign);
+    return _mm_add_ps(_mm_mul_ps(x, wr), xi);
+}
+
+// column n1 of 'rows' values times W_N^(n1 * k2), k2 the row (also used by okfft_ooc.cpp)
+void okfft_layout_fourstep_twiddle(const okfft_plan_t *plan, float *__restrict col, size_t rows, size_t n1)
+{
+    const size_t shift = plan->fs_shift, mask = ((size_t) 1 << shift) - 1;
+    const float *__restrict lo = plan->fs_ws;
+    const float *__restrict hi = lo + 2 * (mask + 1);
+
+    for (size_t k2 = 0, m = 0; k2 < rows; k2 += 2, m += 2 * n1)
+    {
+        __m128 l = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) (lo + 2 * (m & mask)));
+        __m128 h = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) (hi + 2 * (m >> shift)));
+        l = _mm_loadh_pi(l, (const __m64 *) (lo + 2 * ((m + n1) & mask)));
+        h = _mm_loadh_pi(h, (const __m64 *) (hi + 2 * ((m + n1) >> shift)));
+
+        _mm_store_ps(col + 2 * k2, okfft_layout_cmul(_mm_load_ps(col + 2 * k2), okfft_layout_cmul(l, h)));
+    }
+}
+
+// input as the N2 x N1 matrix x[n2][n1] = x[n1 + N1 * n2], X[k2 + N2 * k1] = sum_n1 W_N1^(n1 * k1) W_N^(n1 * k2) Y[k2][n1]
+// with Y the N2 point xforms of the columns. Columns and twiddles in tiles into the scratch matrix Y, then tiles of
+// Y's rows are transformed into scratch and scattered as columns of the N1 x N2 output (the transpose).
+void okfft_layout_fourstep(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    const size_t N2 = plan->dims[0], N1 = plan->dims[1];
+    const okfft_plan_t *col_plan = plan->dim_plans[0];
+    const okfft_plan_t *row_plan = plan->dim_plans[1];
+
+    float *__restrict y = okfft_thread_scratch(OKFFT_SCRATCH_ROWS, 2 * plan->N);
+
+    size_t tile = okfft_layout_tile_width(N2, N1);
+    float *__restrict a = okfft_thread_scratch(OKFFT_SCRATCH_LAYOUT, 4 * N2 * tile);
+    float *__restrict b = a + 2 * N2 * tile;
+
+    for (size_t c = 0; c < N1; c += tile)
+    {
+        okfft_layout_tile_gather(a, input + 2 * c, N2, N1, tile);
+
+        // twiddles while the column is still in L1
+        for (size_t i = 0; i < tile; i++)
+        {
+            col_plan->xform(col_plan, b + 2 * N2 * i, a + 2 * N2 * i);
+            okfft_layout_fourstep_twiddle(plan, b + 2 * N2 * i, N2, c + i);
+        }
+
+        okfft_layout_tile_scatter(y + 2 * c, b, N2, N1, tile);
+    }
+
+    tile = okfft_layout_tile_width(N1, N2);
+
+    for (size_t r = 0; r < N2; r += tile)
+    {
+        for (size_t i = 0; i < tile; i++)
+            row_plan->xform(row_plan, b + 2 * N1 * i, y + 2 * N1 * (r + i));
+
+        okfft_layout_tile_scatter(output + 2 * r, b, N1, N2, tile);
+    }
+}
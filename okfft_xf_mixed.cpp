@@ -0,0 +1,330 @@
+/*
+This file is part of OKFFT
+
+BSD 3-Clause License
+
+Copyright (c) 2012, 2013, Anthony M. Blake <amb@anthonix.com>
+Copyright (c) 2012, The University of Waikato
+Copyright (c) 2015, Jukka Ojanen <jukka.ojanen@kolumbus.fi>
+Copyright (c) 2017, Espen Andreassen <espandre@gmail.com>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+* Neither the name of the organization nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ANTHONY M. BLAKE BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "okfft.h"
+
+#include <string.h> // for memset
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+    #define okfft_force_inline __forceinline
+#else
+    #include <x86intrin.h>
+    #define okfft_force_inline inline __attribute__((always_inline))
+#endif
+
+// Mixed radix xforms for N = P * M, P = 2^a and M = 3^b * 5^c (decimation in time over the M part):
+//
+//  1. M power of two xforms of P points, row n2 = fft_P(x[M * n1 + n2]), using the regular kernels
+//  2. row n2 is multiplied by W_N^(n2 * k1) (fused into the first radix pass)
+//  3. an M point Stockham fft where every element is a whole row of P values, so the radix 3 / 5
+//     butterflies run over contiguous memory and the result lands in natural order
+//
+// The passes ping pong between the output and a per thread scratch buffer, the last one writes the output.
+
+static const __m128 okfft_mixed_fwd_rot = _mm_set_ps(-0.f, 0.f, -0.f, 0.f); // * -i after swapping re / im
+static const __m128 okfft_mixed_inv_rot = _mm_set_ps(0.f, -0.f, 0.f, -0.f); // * +i
+static const __m128 okfft_mixed_cmul_sign = _mm_set_ps(0.f, -0.f, 0.f, -0.f);
+
+#define okfft_mixed_swap_pairs(x) _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1))
+#define okfft_mixed_rot(x)        _mm_xor_ps(okfft_mixed_swap_pairs(x), rot)
+
+// x * w for two interleaved complex values
+static okfft_force_inline __m128 okfft_mixed_cmul(__m128 x, __m128 w)
+{
+    __m128 wr = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 wi = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128 xi = _mm_xor_ps(_mm_mul_ps(okfft_mixed_swap_pairs(x), wi), okfft_mixed_cmul_sign);
+    return _mm_add_ps(_mm_mul_ps(x, wr), xi);
+}
+
+// x * w for a twiddle stored as { wr, wr, wr, wr } { -wi, wi, -wi, wi }
+static okfft_force_inline __m128 okfft_mixed_cmul_const(__m128 x, const float *w)
+{
+    return _mm_add_ps(_mm_mul_ps(x, _mm_load_ps(w)), _mm_mul_ps(okfft_mixed_swap_pairs(x), _mm_load_ps(w + 4)));
+}
+
+// 'count' is 2 (full vector) or 1 (low complex only, for odd row lengths)
+static okfft_force_inline __m128 okfft_mixed_load(const float *p, size_t count)
+{
+    return count == 2 ? _mm_loadu_ps(p) : _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) p);
+}
+
+static okfft_force_inline void okfft_mixed_store(float *p, __m128 x, size_t count)
+{
+    if (count == 2)
+        _mm_storeu_ps(p, x);
+    else
+        _mm_storel_pi((__m64 *) p, x);
+}
+
+#define OKFFT_MIXED_C3_COS -0.5f
+#define OKFFT_MIXED_C3_SIN  0.8660254037844386467637231707529361834714026269051903f
+
+#define OKFFT_MIXED_C5_COS1  0.3090169943749474241022934171828190588601545899028814f
+#define OKFFT_MIXED_C5_COS2 -0.8090169943749474241022934171828190588601545899028814f
+#define OKFFT_MIXED_C5_SIN1  0.9510565162951535721164393333793821434056986341257502f
+#define OKFFT_MIXED_C5_SIN2  0.5877852522924731291687059546390727685976524376431459f
+
+static okfft_force_inline void okfft_mixed_bf3(__m128 *a, const __m128 rot)
+{
+    const __m128 c = _mm_set1_ps(OKFFT_MIXED_C3_COS);
+    const __m128 s = _mm_set1_ps(OKFFT_MIXED_C3_SIN);
+
+    __m128 t1 = _mm_add_ps(a[1], a[2]);
+    __m128 t2 = _mm_add_ps(a[0], _mm_mul_ps(c, t1));
+    __m128 t3 = _mm_mul_ps(s, _mm_sub_ps(a[1], a[2]));
+           t3 = okfft_mixed_rot(t3);
+
+    a[0] = _mm_add_ps(a[0], t1);
+    a[1] = _mm_add_ps(t2, t3);
+    a[2] = _mm_sub_ps(t2, t3);
+}
+
+static okfft_force_inline void okfft_mixed_bf5(__m128 *a, const __m128 rot)
+{
+    const __m128 c1 = _mm_set1_ps(OKFFT_MIXED_C5_COS1);
+    const __m128 c2 = _mm_set1_ps(OKFFT_MIXED_C5_COS2);
+    const __m128 s1 = _mm_set1_ps(OKFFT_MIXED_C5_SIN1);
+    const __m128 s2 = _mm_set1_ps(OKFFT_MIXED_C5_SIN2);
+
+    __m128 t1 = _mm_add_ps(a[1], a[4]);
+    __m128 t2 = _mm_add_ps(a[2], a[3]);
+    __m128 t3 = _mm_sub_ps(a[1], a[4]);
+    __m128 t4 = _mm_sub_ps(a[2], a[3]);
+
+    __m128 m1 = _mm_add_ps(a[0], _mm_add_ps(_mm_mul_ps(c1, t1), _mm_mul_ps(c2, t2)));
+    __m128 m2 = _mm_add_ps(a[0], _mm_add_ps(_mm_mul_ps(c2, t1), _mm_mul_ps(c1, t2)));
+    __m128 n1 = _mm_add_ps(_mm_mul_ps(s1, t3), _mm_mul_ps(s2, t4));
+    __m128 n2 = _mm_sub_ps(_mm_mul_ps(s2, t3), _mm_mul_ps(s1, t4));
+
+    n1 = okfft_mixed_rot(n1);
+    n2 = okfft_mixed_rot(n2);
+
+    a[0] = _mm_add_ps(a[0], _mm_add_ps(t1, t2));
+    a[1] = _mm_add_ps(m1, n1);
+    a[4] = _mm_sub_ps(m1, n1);
+    a[2] = _mm_add_ps(m2, n2);
+    a[3] = _mm_sub_ps(m2, n2);
+}
+
+// radix R butterflies on 'count' (1 or 2) complex values at offset 'i' of every element
+template <size_t R, bool DIT>
+static okfft_force_inline void okfft_mixed_bf(float *const *o, const float *const *s, const float *const *d, const float *w, size_t i, size_t count, bool twiddle, const __m128 rot)
+{
+    __m128 a[R];
+
+    for (size_t j = 0; j < R; j++)
+    {
+        a[j] = okfft_mixed_load(s[j] + i, count);
+        if (DIT)
+            a[j] = okfft_mixed_cmul(a[j], okfft_mixed_load(d[j] + i, count));
+    }
+
+    if (R == 3)
+        okfft_mixed_bf3(a, rot);
+    else
+        okfft_mixed_bf5(a, rot);
+
+    okfft_mixed_store(o[0] + i, a[0], count);
+    for (size_t t = 1; t < R; t++)
+        okfft_mixed_store(o[t] + i, twiddle ? okfft_mixed_cmul_const(a[t], w + 8 * (t - 1)) : a[t], count);
+}
+
+// one radix R Stockham pass over elements of 'L' complex values:
+// dst[R * p + t] = W_n^(p * t) * sum_j src[p + j * m] * W_R^(j * t), with DIT (first pass) element 'e' is pre-multiplied by dit[e]
+template <size_t R, bool DIT>
+static void okfft_mixed_pass(float *__restrict dst, const float *__restrict src, const float *__restrict ws, const float *__restrict dit, size_t m, size_t L, const __m128 rot)
+{
+    const size_t stride = 2 * L;
+    const size_t L2 = L & ~(size_t) 1;
+
+    for (size_t p = 0; p < m; p++)
+    {
+        const float *s[R];
+        const float *d[R];
+        float *o[R];
+
+        for (size_t j = 0; j < R; j++)
+        {
+            s[j] = src + stride * (p + j * m);
+            d[j] = DIT ? dit + stride * (p + j * m) : NULL;
+            o[j] = dst + stride * (R * p + j);
+        }
+
+        const float *w = ws + 8 * (R - 1) * p;
+
+        if (p)
+        {
+            for (size_t i = 0; i < 2 * L2; i += 4)
+                okfft_mixed_bf<R, DIT>(o, s, d, w, i, 2, true, rot);
+        }
+        else
+        {
+            for (size_t i = 0; i < 2 * L2; i += 4)
+                okfft_mixed_bf<R, DIT>(o, s, d, w, i, 2, false, rot);
+        }
+
+        // odd element sizes (no power of two part)
+        if (L & 1)
+            okfft_mixed_bf<R, DIT>(o, s, d, w, 2 * L2, 1, p != 0, rot);
+    }
+}
+
+// per thread scratch (okfft.cpp)
+float *okfft_thread_scratch(size_t slot, size_t size);
+
+static void okfft_mixed_xform(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input, const __m128 rot)
+{
+    const size_t N = plan->N;
+    const size_t M = plan->M;
+    const size_t P = N / M;
+    const size_t passes = plan->radix_count;
+
+    float *scratch = okfft_thread_scratch(OKFFT_SCRATCH_XFORM, 2 * N + 2 * P);
+    float *T = scratch + 2 * N;
+
+    // pass i writes the output when (passes - 1 - i) is even
+    float *bufs[2] = { output, scratch };
+    const float *src = input;
+
+    if (P > 1)
+    {
+        float *rows = bufs[passes & 1];
+
+        for (size_t n2 = 0; n2 < M; n2++)
+        {
+            const uint64_t *__restrict x = (const uint64_t *) input + n2;
+            uint64_t *__restrict t = (uint64_t *) T;
+
+            for (size_t n1 = 0; n1 < P; n1++)
+                t[n1] = x[n1 * M];
+
+            plan->sub->xform(plan->sub, rows + 2 * n2 * P, T);
+        }
+
+        src = rows;
+    }
+
+    const float *ws = plan->mr_ws;
+    size_t n = M;
+
+    for (size_t i = 0; i < passes; i++)
+    {
+        const size_t R = plan->radix[i];
+        const size_t m = n / R;
+        const size_t L = (M / n) * P;
+        float *dst = bufs[(passes - 1 - i) & 1];
+
+        if (i == 0 && P > 1)
+        {
+            if (R == 3)
+                okfft_mixed_pass<3, true>(dst, src, ws, plan->mr_dit, m, L, rot);
+            else
+                okfft_mixed_pass<5, true>(dst, src, ws, plan->mr_dit, m, L, rot);
+        }
+        else
+        {
+            if (R == 3)
+                okfft_mixed_pass<3, false>(dst, src, ws, NULL, m, L, rot);
+            else
+                okfft_mixed_pass<5, false>(dst, src, ws, NULL, m, L, rot);
+        }
+
+        ws += 8 * (R - 1) * m;
+        n = m;
+        src = dst;
+    }
+}
+
+void okfft_mixed_fwd(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    okfft_mixed_xform(plan, output, input, okfft_mixed_fwd_rot);
+}
+
+void okfft_mixed_inv(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    okfft_mixed_xform(plan, output, input, okfft_mixed_inv_rot);
+}
+
+// BLUESTEIN
+// any other N, as a convolution with the chirp w_n = exp(-i pi n^2 / N) (conjugated for the inverse):
+//
+//   X_k = w_k * sum_n (x_n * w_n) * conj(w_(k - n))
+//
+// The convolution is done with a power of two xform of L >= 2N - 1 points, and its inverse as
+// conj(fft_L(conj(.))), so a single forward plan is needed. The chirp multiplies, the multiply with the
+// precomputed chirp spectrum and the conjugations are fused into the passes around the two xforms.
+
+static const __m128 okfft_bluestein_conj = _mm_set_ps(-0.f, 0.f, -0.f, 0.f);
+
+void okfft_bluestein(const okfft_plan_t *plan, float *__restrict output, const float *__restrict input)
+{
+    const size_t N = plan->N;
+    const size_t L = plan->sub->N;
+    const size_t N2 = N & ~(size_t) 1;
+    const float *__restrict w = plan->chirp;
+    const float *__restrict B = plan->chirp_ft;
+
+    float *__restrict a = okfft_thread_scratch(OKFFT_SCRATCH_XFORM, 4 * L);
+    float *__restrict c = a + 2 * L;
+
+    // a_n = x_n * w_n, zero padded to L
+    for (size_t i = 0; i < 2 * N2; i += 4)
+        _mm_store_ps(a + i, okfft_mixed_cmul(_mm_loadu_ps(input + i), _mm_load_ps(w + i)));
+
+    if (N & 1)
+        okfft_mixed_store(a + 2 * N2, okfft_mixed_cmul(okfft_mixed_load(input + 2 * N2, 1), okfft_mixed_load(w + 2 * N2, 1)), 1);
+
+    memset(a + 2 * N, 0, 2 * (L - N) * sizeof(float));
+
+    plan->sub->xform(plan->sub, c, a);
+
+    // conj(A * B), B already scaled by 1 / L
+    for (size_t i = 0; i < 2 * L; i += 4)
+        _mm_store_ps(a + i, _mm_xor_ps(okfft_mixed_cmul(_mm_load_ps(c + i), _mm_load_ps(B + i)), okfft_bluestein_conj));
+
+    plan->sub->xform(plan->sub, c, a);
+
+    // X_k = w_k * conj(c_k)
+    for (size_t i = 0; i < 2 * N2; i += 4)
+        _mm_storeu_ps(output + i, okfft_mixed_cmul(_mm_xor_ps(_mm_load_ps(c + i), okfft_bluestein_conj), _mm_load_ps(w + i)));
+
+    if (N & 1)
+        okfft_mixed_store(output + 2 * N2, okfft_mixed_cmul(_mm_xor_ps(okfft_mixed_load(c + 2 * N2, 1), okfft_bluestein_conj), okfft_mixed_load(w + 2 * N2, 1)), 1);
+}
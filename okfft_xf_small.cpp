@@ -35,24 +35,17 @@ void okfft_small_2(const okfft_plan_t *, float *__restrict out, const float *__r
 
 void okfft_small_fwd_4(const okfft_plan_t *, float *__restrict out, const float *__restrict in)
 {
-    const __m128 mask0 = { 0.f, 0.f, -0.f, -0.f };
     const __m128 mask1 = { 0.f, 0.f,  0.f, -0.f };
 
-    // 2x radix2
+    // 2x radix2 (x0 +- x2, x1 +- x3)
     __m128 d0 = _mm_load_ps(in + 0);
     __m128 d1 = _mm_load_ps(in + 4);
 
-    __m128 q0 = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(1, 0, 1, 0));
-    __m128 q1 = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(3, 2, 3, 2));
+    __m128 s = _mm_add_ps(d0, d1);
+    __m128 d = _mm_sub_ps(d0, d1);
 
-    __m128 q2 = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(1, 0, 1, 0));
-    __m128 q3 = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(3, 2, 3, 2));
-
-    q1 = _mm_xor_ps(q1, mask0);
-    q3 = _mm_xor_ps(q3, mask0);
-
-    __m128 t4t5 = _mm_add_ps(q0, q1);
-    __m128 t6t7 = _mm_add_ps(q2, q3);
+    __m128 t4t5 = _mm_shuffle_ps(s, d, _MM_SHUFFLE(1, 0, 1, 0));
+    __m128 t6t7 = _mm_shuffle_ps(s, d, _MM_SHUFFLE(3, 2, 3, 2));
 
     // radix 4
     t6t7 = _mm_shuffle_ps(t6t7, t6t7, _MM_SHUFFLE(2, 3, 1, 0));
@@ -67,24 +60,17 @@ void okfft_small_fwd_4(const okfft_plan_t *, float *__restrict out, const float
 
 void okfft_small_inv_4(const okfft_plan_t *, float *__restrict out, const float *__restrict in)
 {
-    const __m128 mask0 = { 0.f, 0.f, -0.f, -0.f };
     const __m128 mask1 = { 0.f, 0.f, -0.f,  0.f };
 
-    // 2x radix2
+    // 2x radix2 (x0 +- x2, x1 +- x3)
     __m128 d0 = _mm_load_ps(in + 0);
     __m128 d1 = _mm_load_ps(in + 4);
 
-    __m128 q0 = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(1, 0, 1, 0));
-    __m128 q1 = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(3, 2, 3, 2));
-
-    __m128 q2 = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(1, 0, 1, 0));
-    __m128 q3 = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(3, 2, 3, 2));
+    __m128 s = _mm_add_ps(d0, d1);
+    __m128 d = _mm_sub_ps(d0, d1);
 
-    q1 = _mm_xor_ps(q1, mask0);
-    q3 = _mm_xor_ps(q3, mask0);
-
-    __m128 t4t5 = _mm_add_ps(q0, q1);
-    __m128 t6t7 = _mm_add_ps(q2, q3);
+    __m128 t4t5 = _mm_shuffle_ps(s, d, _MM_SHUFFLE(1, 0, 1, 0));
+    __m128 t6t7 = _mm_shuffle_ps(s, d, _MM_SHUFFLE(3, 2, 3, 2));
 
     // radix 4
     t6t7 = _mm_shuffle_ps(t6t7, t6t7, _MM_SHUFFLE(2, 3, 1, 0));
@@ -201,3 +187,105 @@ void okfft_small_inv_16(const okfft_plan_t *, float *__restrict out, const float
     okfft_sse_store4(out + 0, r01, r23, r45, r67);
     okfft_sse_store4(out + 16, r89, r1011, r1213, r1415);
 }
+
+// REAL XFORMS, N = 4, 8, 16 and 32
+// the N real values are done as an N / 2 point complex xform, followed (forward) or preceded (inverse) by
+//
+//   X_k = Z_k * A_k + conj(Z_(N/2 - k)) * B_k,   A_k = (1 - i W_N^k) / 2, B_k = (1 + i W_N^k) / 2
+//
+// with conj(2 A_k) and conj(2 B_k) for the inverse. The coeffs are stored per two k as { re, re, re', re' } { -im, im, -im', im' }
+// for A and B (see 'okfft_init_small_real_coeffs'), everything stays in registers or on the stack
+
+static const __m128 okfft_small_real_conj = _mm_set_ps(-0.f, 0.f, -0.f, 0.f);
+
+// x * A_k + conj(y_(M - k)) * B_k for k, k + 1 (k even), y_(M - k) is the low half of 'y0' and y_(M - k - 1) the high half of 'y1'
+static inline __m128 okfft_small_real_split(__m128 x, __m128 y0, __m128 y1, const float *__restrict lut)
+{
+    __m128 y = _mm_xor_ps(_mm_shuffle_ps(y0, y1, _MM_SHUFFLE(3, 2, 1, 0)), okfft_small_real_conj);
+
+    __m128 r0 = _mm_add_ps(_mm_mul_ps(x, _mm_load_ps(lut + 0)), _mm_mul_ps(okfft_sse_swap_pairs(x), _mm_load_ps(lut + 4)));
+    __m128 r1 = _mm_add_ps(_mm_mul_ps(y, _mm_load_ps(lut + 8)), _mm_mul_ps(okfft_sse_swap_pairs(y), _mm_load_ps(lut + 12)));
+    return _mm_add_ps(r0, r1);
+}
+
+// Z_M wraps around to Z_0
+template <size_t M>
+static inline void okfft_small_real_fwd_post(float *__restrict out, const float *__restrict Z, const float *__restrict lut)
+{
+    __m128 z0 = _mm_load_ps(Z);
+
+    _mm_store_ps(out, okfft_small_real_split(z0, z0, _mm_load_ps(Z + 2 * M - 4), lut));
+    for (size_t k = 2; k < M; k += 2)
+        _mm_store_ps(out + 2 * k, okfft_small_real_split(_mm_load_ps(Z + 2 * k), _mm_load_ps(Z + 2 * (M - k)), _mm_load_ps(Z + 2 * (M - k) - 4), lut + 8 * k));
+
+    // X_M = re(Z_0) - im(Z_0)
+    __m128 xm = _mm_sub_ss(z0, _mm_shuffle_ps(z0, z0, _MM_SHUFFLE(1, 1, 1, 1)));
+    _mm_storel_pi((__m64 *) (out + 2 * M), _mm_move_ss(_mm_setzero_ps(), xm));
+}
+
+// 'in' holds M + 1 complex values
+template <size_t M>
+static inline void okfft_small_real_inv_pre(float *__restrict Z, const float *__restrict in, const float *__restrict lut)
+{
+    __m128 xm = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) (in + 2 * M));
+
+    _mm_store_ps(Z, okfft_small_real_split(_mm_load_ps(in), xm, _mm_load_ps(in + 2 * M - 4), lut));
+    for (size_t k = 2; k < M; k += 2)
+        _mm_store_ps(Z + 2 * k, okfft_small_real_split(_mm_load_ps(in + 2 * k), _mm_load_ps(in + 2 * (M - k)), _mm_load_ps(in + 2 * (M - k) - 4), lut + 8 * k));
+}
+
+void okfft_small_real_fwd_4(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in)
+{
+    OKFFT_ALIGN(16) float Z[4];
+    okfft_small_2(plan, Z, in);
+    okfft_small_real_fwd_post<2>(out, Z, plan->A);
+}
+
+void okfft_small_real_fwd_8(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in)
+{
+    OKFFT_ALIGN(16) float Z[8];
+    okfft_small_fwd_4(plan, Z, in);
+    okfft_small_real_fwd_post<4>(out, Z, plan->A);
+}
+
+void okfft_small_real_fwd_16(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in)
+{
+    OKFFT_ALIGN(16) float Z[16];
+    okfft_small_fwd_8(plan, Z, in);
+    okfft_small_real_fwd_post<8>(out, Z, plan->A);
+}
+
+void okfft_small_real_fwd_32(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in)
+{
+    OKFFT_ALIGN(16) float Z[32];
+    okfft_small_fwd_16(plan, Z, in);
+    okfft_small_real_fwd_post<16>(out, Z, plan->A);
+}
+
+void okfft_small_real_inv_4(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in)
+{
+    OKFFT_ALIGN(16) float Z[4];
+    okfft_small_real_inv_pre<2>(Z, in, plan->A);
+    okfft_small_2(plan, out, Z);
+}
+
+void okfft_small_real_inv_8(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in)
+{
+    OKFFT_ALIGN(16) float Z[8];
+    okfft_small_real_inv_pre<4>(Z, in, plan->A);
+    okfft_small_inv_4(plan, out, Z);
+}
+
+void okfft_small_real_inv_16(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in)
+{
+    OKFFT_ALIGN(16) float Z[16];
+    okfft_small_real_inv_pre<8>(Z, in, plan->A);
+    okfft_small_inv_8(plan, out, Z);
+}
+
+void okfft_small_real_inv_32(const okfft_plan_t *plan, float *__restrict out, const float *__restrict in)
+{
+    OKFFT_ALIGN(16) float Z[32];
+    okfft_small_real_inv_pre<16>(Z, in, plan->A);
+    okfft_small_inv_16(plan, out, Z);
+}
@@ -331,6 +331,33 @@ void okfft_sse_fwd_generic(const okfft_plan_t *plan, float *__restrict output, c
     okfft_sse_xf_fwd_rec(plan, output, plan->N);
 }
 
+// combine passes only of an N point xform (N <= plan->N), for the layout and parallel leaf passes
+void okfft_sse_fwd_passes(const okfft_plan_t *plan, float *__restrict data, size_t N)
+{
+    switch (N)
+    {
+    case   32: okfft_sse_xf_fwd_32(plan, data);  break;
+    case   64: okfft_sse_xf_fwd_64(plan, data);  break;
+    case  128: okfft_sse_xf_fwd_128(plan, data); break;
+    case  256: okfft_sse_xf_fwd_256(plan, data); break;
+    case  512: okfft_sse_xf_fwd_512(plan, data); break;
+    case 1024: okfft_sse_xf_fwd_1k(plan, data);  break;
+    case 2048: okfft_sse_xf_fwd_2k(plan, data);  break;
+    case 4096: okfft_sse_xf_fwd_4k(plan, data);  break;
+    case 8192: okfft_sse_xf_fwd_8k(plan, data);  break;
+    default:   okfft_sse_xf_fwd_rec(plan, data, N); break;
+    }
+}
+
+// one slice of the radix 8 combine of the N point passes, floats [begin, end) of each of its 8 streams (multiples of 16)
+void okfft_sse_fwd_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end)
+{
+    const __m128 sse_sign_mask = okfft_sse_fwd_sign_mask;
+    const ptrdiff_t *__restrict ws_is = plan->ws_is;
+    const float *__restrict ws = plan->ws;
+    OKFFT_SSE_X8_PART(N, data, ws + (ws_is[okfft_sse_ilog2(N) - 4] << 1), begin, end);
+}
+
 void okfft_sse_fwd_real(float *__restrict output, float *__restrict buffer, const float *__restrict A, const float *__restrict B, size_t N)
 {
     buffer[N + 0] = buffer[0];
@@ -671,6 +698,33 @@ void okfft_sse_inv_generic(const okfft_plan_t *plan, float *__restrict output, c
     okfft_sse_xf_inv_rec(plan, output, plan->N);
 }
 
+// combine passes only of an N point xform (N <= plan->N), for the layout and parallel leaf passes
+void okfft_sse_inv_passes(const okfft_plan_t *plan, float *__restrict data, size_t N)
+{
+    switch (N)
+    {
+    case   32: okfft_sse_xf_inv_32(plan, data);  break;
+    case   64: okfft_sse_xf_inv_64(plan, data);  break;
+    case  128: okfft_sse_xf_inv_128(plan, data); break;
+    case  256: okfft_sse_xf_inv_256(plan, data); break;
+    case  512: okfft_sse_xf_inv_512(plan, data); break;
+    case 1024: okfft_sse_xf_inv_1k(plan, data);  break;
+    case 2048: okfft_sse_xf_inv_2k(plan, data);  break;
+    case 4096: okfft_sse_xf_inv_4k(plan, data);  break;
+    case 8192: okfft_sse_xf_inv_8k(plan, data);  break;
+    default:   okfft_sse_xf_inv_rec(plan, data, N); break;
+    }
+}
+
+// one slice of the radix 8 combine of the N point passes, floats [begin, end) of each of its 8 streams (multiples of 16)
+void okfft_sse_inv_x8(const okfft_plan_t *plan, float *__restrict data, size_t N, size_t begin, size_t end)
+{
+    const __m128 sse_sign_mask = okfft_sse_inv_sign_mask;
+    const ptrdiff_t *__restrict ws_is = plan->ws_is;
+    const float *__restrict ws = plan->ws;
+    OKFFT_SSE_X8_PART(N, data, ws + (ws_is[okfft_sse_ilog2(N) - 4] << 1), begin, end);
+}
+
 void okfft_sse_inv_real(float *__restrict output, const float *__restrict input, const float *__restrict A, const float *__restrict B, size_t N)
 {
     for (size_t i = 0; i < N; i += 16)
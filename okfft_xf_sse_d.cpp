@@ -0,0 +1,402 @@
+/*
+This file is part of OKFFT
+
+BSD 3-Clause License
+
+Copyright (c) 2012, 2013, Anthony M. Blake <amb@anthonix.com>
+Copyright (c) 2012, The University of Waikato
+Copyright (c) 2015, Jukka Ojanen <jukka.ojanen@kolumbus.fi>
+Copyright (c) 2017, Espen Andreassen <espandre@gmail.com>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+* Neither the name of the organization nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ANTHONY M. BLAKE BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "okfft.h"
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+    #define okfft_force_inline __forceinline
+    #define OKFFT_ALIGN(x) __declspec(align(x))
+#else
+    #include <x86intrin.h>
+    #define okfft_force_inline inline __attribute__((always_inline))
+    #define OKFFT_ALIGN(x) __attribute__((aligned(x)))
+#endif
+
+// SSE2 double vector, two __m128d halves holding one complex value each
+struct okfft_vd { __m128d lo, hi; };
+
+static okfft_force_inline okfft_vd okfft_vd_make(__m128d lo, __m128d hi)
+{
+    okfft_vd r = { lo, hi };
+    return r;
+}
+
+static okfft_force_inline okfft_vd okfft_vd_load(const double *p)  { return okfft_vd_make(_mm_load_pd(p),  _mm_load_pd(p + 2)); }
+static okfft_force_inline okfft_vd okfft_vd_loadu(const double *p) { return okfft_vd_make(_mm_loadu_pd(p), _mm_loadu_pd(p + 2)); }
+
+static okfft_force_inline void okfft_vd_store(double *p, okfft_vd x)
+{
+    _mm_store_pd(p,     x.lo);
+    _mm_store_pd(p + 2, x.hi);
+}
+
+static okfft_force_inline okfft_vd okfft_vd_add(okfft_vd x, okfft_vd y) { return okfft_vd_make(_mm_add_pd(x.lo, y.lo), _mm_add_pd(x.hi, y.hi)); }
+static okfft_force_inline okfft_vd okfft_vd_sub(okfft_vd x, okfft_vd y) { return okfft_vd_make(_mm_sub_pd(x.lo, y.lo), _mm_sub_pd(x.hi, y.hi)); }
+static okfft_force_inline okfft_vd okfft_vd_mul(okfft_vd x, okfft_vd y) { return okfft_vd_make(_mm_mul_pd(x.lo, y.lo), _mm_mul_pd(x.hi, y.hi)); }
+static okfft_force_inline okfft_vd okfft_vd_xor(okfft_vd x, okfft_vd y) { return okfft_vd_make(_mm_xor_pd(x.lo, y.lo), _mm_xor_pd(x.hi, y.hi)); }
+
+static okfft_force_inline okfft_vd okfft_vd_swap_pairs(okfft_vd x)
+{
+    return okfft_vd_make(_mm_shuffle_pd(x.lo, x.lo, 1), _mm_shuffle_pd(x.hi, x.hi, 1));
+}
+
+#define okfft_vd_swap_sign(x)    okfft_vd_xor(x, vd_sign_mask)
+#define okfft_vd_unpack_lo(x, y) okfft_vd_make((x).lo, (y).lo)
+#define okfft_vd_unpack_hi(x, y) okfft_vd_make((x).hi, (y).hi)
+#define okfft_vd_blend(x, y)     okfft_vd_make((x).lo, (y).hi)
+
+#include "okfft_macros_d.h"
+
+#define OKFFT_SQRT_HALF_D 0.7071067811865475244008443621048490392848359376884740
+
+static const OKFFT_ALIGN(16) double okfft_sse_d_inv_constants[16] =
+{
+    OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+    OKFFT_SQRT_HALF_D,  -OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,  -OKFFT_SQRT_HALF_D,
+    1.0,                 1.0,                 OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+    0.0,                 0.0,                 OKFFT_SQRT_HALF_D,  -OKFFT_SQRT_HALF_D,
+};
+
+static const OKFFT_ALIGN(16) double okfft_sse_d_fwd_constants[16] =
+{
+     OKFFT_SQRT_HALF_D,  OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+    -OKFFT_SQRT_HALF_D,  OKFFT_SQRT_HALF_D,  -OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+     1.0,                1.0,                 OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+     0.0,                0.0,                -OKFFT_SQRT_HALF_D,   OKFFT_SQRT_HALF_D,
+};
+
+static const okfft_vd okfft_sse_d_fwd_sign_mask = { _mm_set_pd(-0.0, 0.0), _mm_set_pd(-0.0, 0.0) };
+static const okfft_vd okfft_sse_d_inv_sign_mask = { _mm_set_pd(0.0, -0.0), _mm_set_pd(0.0, -0.0) };
+
+static okfft_force_inline size_t okfft_sse_d_ilog2(size_t N)
+{
+#ifdef _MSC_VER
+    unsigned long l2;
+    _BitScanForward64(&l2, N);
+    return l2;
+#else
+    return __builtin_ctzll(N);
+#endif
+}
+
+// split radix recursion of the unrolled float kernels, N / 4, N / 8, N / 8, N / 4, N / 4 and an X8 pass to join them
+static void okfft_sse_d_xf_rec(const okfft_plan_d_t *plan, double *__restrict data, size_t N, const okfft_vd vd_sign_mask)
+{
+    const ptrdiff_t *__restrict ws_is = plan->ws_is;
+    const double *__restrict ws = plan->ws;
+
+    if (N == 16)
+    {
+        OKFFT_VD_X4(data, ws);
+    }
+    else if (N >= 32)
+    {
+        if (N > 32)
+        {
+            size_t N2 = N >> 1;
+            size_t N4 = N >> 2;
+            size_t N8 = N >> 3;
+
+            okfft_sse_d_xf_rec(plan, data, N4, vd_sign_mask);
+            okfft_sse_d_xf_rec(plan, data + N2, N8, vd_sign_mask);
+            okfft_sse_d_xf_rec(plan, data + N2 + N4, N8, vd_sign_mask);
+            okfft_sse_d_xf_rec(plan, data + N, N4, vd_sign_mask);
+            okfft_sse_d_xf_rec(plan, data + N + N2, N4, vd_sign_mask);
+        }
+
+        OKFFT_VD_X8(N, data, ws + (ws_is[okfft_sse_d_ilog2(N) - 4] << 1));
+    }
+}
+
+void okfft_sse_d_fwd(const okfft_plan_d_t *plan, double *__restrict output, const double *__restrict input)
+{
+    const okfft_vd vd_sign_mask = okfft_sse_d_fwd_sign_mask;
+    const double *__restrict vd_constants = okfft_sse_d_fwd_constants;
+    size_t i0 = plan->i0, i1 = plan->i1;
+    if (okfft_sse_d_ilog2(plan->N) & 1) // check if ilog2(N) is odd
+    {
+        OKFFT_VD_FP_ODD(i0, i1, plan, output, input)
+    }
+    else
+    {
+        OKFFT_VD_FP_EVEN(i0, i1, plan, output, input)
+    }
+
+    okfft_sse_d_xf_rec(plan, output, plan->N, vd_sign_mask);
+}
+
+void okfft_sse_d_inv(const okfft_plan_d_t *plan, double *__restrict output, const double *__restrict input)
+{
+    const okfft_vd vd_sign_mask = okfft_sse_d_inv_sign_mask;
+    const double *__restrict vd_constants = okfft_sse_d_inv_constants;
+    size_t i0 = plan->i0, i1 = plan->i1;
+    if (okfft_sse_d_ilog2(plan->N) & 1) // check if ilog2(N) is odd
+    {
+        OKFFT_VD_FP_ODD(i0, i1, plan, output, input)
+    }
+    else
+    {
+        OKFFT_VD_FP_EVEN(i0, i1, plan, output, input)
+    }
+
+    okfft_sse_d_xf_rec(plan, output, plan->N, vd_sign_mask);
+}
+
+// ================= REAL =======================================
+// shared by all kernel sets, A and B are stored as { re0, re1, im0, im1 } per pair of complex values
+
+void okfft_sse_d_fwd_real(double *__restrict output, double *__restrict buffer, const double *__restrict A, const double *__restrict B, size_t N)
+{
+    buffer[N + 0] = buffer[0];
+    buffer[N + 1] = buffer[1];
+
+    for (size_t i = 0; i < N; i += 4)
+    {
+        __m128d x0 = _mm_load_pd(buffer + i + 0);
+        __m128d x1 = _mm_load_pd(buffer + i + 2);
+        __m128d y0 = _mm_load_pd(buffer + N - i - 0);
+        __m128d y1 = _mm_load_pd(buffer + N - i - 2);
+
+        __m128d xre = _mm_unpacklo_pd(x0, x1);
+        __m128d xim = _mm_unpackhi_pd(x0, x1);
+        __m128d yre = _mm_unpacklo_pd(y0, y1);
+        __m128d yim = _mm_unpackhi_pd(y0, y1);
+
+        __m128d are = _mm_load_pd(A + i + 0);
+        __m128d aim = _mm_load_pd(A + i + 2);
+        __m128d bre = _mm_load_pd(B + i + 0);
+        __m128d bim = _mm_load_pd(B + i + 2);
+
+        __m128d re0 = _mm_sub_pd(_mm_mul_pd(xre, are), _mm_mul_pd(xim, aim));
+        __m128d re1 = _mm_add_pd(_mm_mul_pd(yre, bre), _mm_mul_pd(yim, bim));
+        __m128d im0 = _mm_add_pd(_mm_mul_pd(xim, are), _mm_mul_pd(xre, aim));
+        __m128d im1 = _mm_sub_pd(_mm_mul_pd(yre, bim), _mm_mul_pd(yim, bre));
+
+        __m128d re = _mm_add_pd(re0, re1);
+        __m128d im = _mm_add_pd(im0, im1);
+
+        _mm_store_pd(output + i + 0, _mm_unpacklo_pd(re, im));
+        _mm_store_pd(output + i + 2, _mm_unpackhi_pd(re, im));
+    }
+
+    output[N + 0] = buffer[0] - buffer[1];
+    output[N + 1] = 0.0;
+}
+
+void okfft_sse_d_inv_real(double *__restrict output, const double *__restrict input, const double *__restrict A, const double *__restrict B, size_t N)
+{
+    for (size_t i = 0; i < N; i += 4)
+    {
+        __m128d x0 = _mm_load_pd(input + i + 0);
+        __m128d x1 = _mm_load_pd(input + i + 2);
+        __m128d y0 = _mm_load_pd(input + N - i - 0);
+        __m128d y1 = _mm_load_pd(input + N - i - 2);
+
+        __m128d xre = _mm_unpacklo_pd(x0, x1);
+        __m128d xim = _mm_unpackhi_pd(x0, x1);
+        __m128d yre = _mm_unpacklo_pd(y0, y1);
+        __m128d yim = _mm_unpackhi_pd(y0, y1);
+
+        __m128d are = _mm_load_pd(A + i + 0);
+        __m128d aim = _mm_load_pd(A + i + 2);
+        __m128d bre = _mm_load_pd(B + i + 0);
+        __m128d bim = _mm_load_pd(B + i + 2);
+
+        __m128d re0 = _mm_add_pd(_mm_mul_pd(xre, are), _mm_mul_pd(xim, aim));
+        __m128d re1 = _mm_sub_pd(_mm_mul_pd(yre, bre), _mm_mul_pd(yim, bim));
+        __m128d im0 = _mm_sub_pd(_mm_mul_pd(xim, are), _mm_mul_pd(xre, aim));
+        __m128d im1 = _mm_add_pd(_mm_mul_pd(yre, bim), _mm_mul_pd(yim, bre));
+
+        __m128d re = _mm_add_pd(re0, re1);
+        __m128d im = _mm_sub_pd(im0, im1);
+
+        _mm_store_pd(output + i + 0, _mm_unpacklo_pd(re, im));
+        _mm_store_pd(output + i + 2, _mm_unpackhi_pd(re, im));
+    }
+}
+
+// ================= SMALL ======================================
+
+void okfft_small_d_2(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in)
+{
+    __m128d x0 = _mm_load_pd(in + 0);
+    __m128d x1 = _mm_load_pd(in + 2);
+
+    _mm_store_pd(out + 0, _mm_add_pd(x0, x1));
+    _mm_store_pd(out + 2, _mm_sub_pd(x0, x1));
+}
+
+// 'mask' holds the sign applied after swapping re / im, i.e. multiplies by -i (forward) or +i (inverse)
+static okfft_force_inline void okfft_small_d_4(double *__restrict out, const double *__restrict in, const __m128d mask)
+{
+    __m128d x0 = _mm_load_pd(in + 0);
+    __m128d x1 = _mm_load_pd(in + 2);
+    __m128d x2 = _mm_load_pd(in + 4);
+    __m128d x3 = _mm_load_pd(in + 6);
+
+    // 2x radix2 (x0 +- x2, x1 +- x3)
+    __m128d s0 = _mm_add_pd(x0, x2);
+    __m128d d0 = _mm_sub_pd(x0, x2);
+    __m128d s1 = _mm_add_pd(x1, x3);
+    __m128d d1 = _mm_sub_pd(x1, x3);
+
+    // radix 4
+    d1 = _mm_shuffle_pd(d1, d1, 1);
+    d1 = _mm_xor_pd(d1, mask);
+
+    _mm_store_pd(out + 0, _mm_add_pd(s0, s1));
+    _mm_store_pd(out + 2, _mm_add_pd(d0, d1));
+    _mm_store_pd(out + 4, _mm_sub_pd(s0, s1));
+    _mm_store_pd(out + 6, _mm_sub_pd(d0, d1));
+}
+
+void okfft_small_d_fwd_4(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in)
+{
+    okfft_small_d_4(out, in, _mm_set_pd(-0.0, 0.0));
+}
+
+void okfft_small_d_inv_4(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in)
+{
+    okfft_small_d_4(out, in, _mm_set_pd(0.0, -0.0));
+}
+
+#define OKFFT_COS_PI_8_D 0.9238795325112867561281831893967882868224166258636425
+#define OKFFT_SIN_PI_8_D 0.3826834323650897717284599840303988667613445624856270
+
+static const OKFFT_ALIGN(16) double okfft_small_d_fwd_constants[24] =
+{
+    1.0, 1.0,  OKFFT_SQRT_HALF_D, OKFFT_SQRT_HALF_D,
+    -0.0, 0.0, -OKFFT_SQRT_HALF_D, OKFFT_SQRT_HALF_D,
+
+    1.0, 1.0,  OKFFT_COS_PI_8_D, OKFFT_COS_PI_8_D,
+    -0.0, 0.0, -OKFFT_SIN_PI_8_D, OKFFT_SIN_PI_8_D,
+
+    OKFFT_SQRT_HALF_D, OKFFT_SQRT_HALF_D,  OKFFT_SIN_PI_8_D, OKFFT_SIN_PI_8_D,
+    -OKFFT_SQRT_HALF_D, OKFFT_SQRT_HALF_D, -OKFFT_COS_PI_8_D, OKFFT_COS_PI_8_D
+};
+
+static const OKFFT_ALIGN(16) double okfft_small_d_inv_constants[24] =
+{
+    1.0,  1.0, OKFFT_SQRT_HALF_D,  OKFFT_SQRT_HALF_D,
+    0.0, -0.0, OKFFT_SQRT_HALF_D, -OKFFT_SQRT_HALF_D,
+
+    1.0,  1.0, OKFFT_COS_PI_8_D,  OKFFT_COS_PI_8_D,
+    0.0, -0.0, OKFFT_SIN_PI_8_D, -OKFFT_SIN_PI_8_D,
+
+    OKFFT_SQRT_HALF_D,  OKFFT_SQRT_HALF_D, OKFFT_SIN_PI_8_D,  OKFFT_SIN_PI_8_D,
+    OKFFT_SQRT_HALF_D, -OKFFT_SQRT_HALF_D, OKFFT_COS_PI_8_D, -OKFFT_COS_PI_8_D
+};
+
+void okfft_small_d_fwd_8(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in)
+{
+    const okfft_vd vd_sign_mask = okfft_sse_d_fwd_sign_mask;
+    const double *__restrict lut = okfft_small_d_fwd_constants;
+
+    okfft_vd r01, r23, r45, r67;
+    OKFFT_VD_L42(in + 0, in + 8, in + 4, in + 12, r01, r23, r45, r67);
+
+    okfft_vd re = okfft_vd_load(lut);
+    okfft_vd im = okfft_vd_load(lut + 4);
+    OKFFT_VD_KN(re, im, r01, r23, r45, r67);
+
+    okfft_vd_store4(out, r01, r23, r45, r67);
+}
+
+void okfft_small_d_inv_8(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in)
+{
+    const okfft_vd vd_sign_mask = okfft_sse_d_inv_sign_mask;
+    const double *__restrict lut = okfft_small_d_inv_constants;
+
+    okfft_vd r01, r23, r45, r67;
+    OKFFT_VD_L42(in + 0, in + 8, in + 4, in + 12, r01, r23, r45, r67);
+
+    okfft_vd re = okfft_vd_load(lut);
+    okfft_vd im = okfft_vd_load(lut + 4);
+    OKFFT_VD_KN(re, im, r01, r23, r45, r67);
+
+    okfft_vd_store4(out, r01, r23, r45, r67);
+}
+
+void okfft_small_d_fwd_16(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in)
+{
+    const okfft_vd vd_sign_mask = okfft_sse_d_fwd_sign_mask;
+    const double *__restrict lut = okfft_small_d_fwd_constants;
+
+    okfft_vd r01, r23, r45, r67, r89, r1011, r1213, r1415;
+
+    OKFFT_VD_L44(in + 0, in + 16, in + 8, in + 24, r01, r23, r89, r1011);
+    OKFFT_VD_L24(in + 4, in + 20, in + 28, in + 12, r45, r67, r1415, r1213);
+
+    okfft_vd re0 = okfft_vd_load(lut + 0);
+    okfft_vd im0 = okfft_vd_load(lut + 4);
+    okfft_vd re1 = okfft_vd_load(lut + 8);
+    okfft_vd im1 = okfft_vd_load(lut + 12);
+    okfft_vd re2 = okfft_vd_load(lut + 16);
+    okfft_vd im2 = okfft_vd_load(lut + 20);
+
+    OKFFT_VD_KN(re0, im0, r01, r23, r45, r67);
+    OKFFT_VD_KNKN(re1, im1, re2, im2, r01, r45, r89, r1213, r23, r67, r1011, r1415);
+
+    okfft_vd_store4(out + 0, r01, r23, r45, r67);
+    okfft_vd_store4(out + 16, r89, r1011, r1213, r1415);
+}
+
+void okfft_small_d_inv_16(const okfft_plan_d_t *, double *__restrict out, const double *__restrict in)
+{
+    const okfft_vd vd_sign_mask = okfft_sse_d_inv_sign_mask;
+    const double *__restrict lut = okfft_small_d_inv_constants;
+
+    okfft_vd r01, r23, r45, r67, r89, r1011, r1213, r1415;
+
+    OKFFT_VD_L44(in + 0, in + 16, in + 8, in + 24, r01, r23, r89, r1011);
+    OKFFT_VD_L24(in + 4, in + 20, in + 28, in + 12, r45, r67, r1415, r1213);
+
+    okfft_vd re0 = okfft_vd_load(lut + 0);
+    okfft_vd im0 = okfft_vd_load(lut + 4);
+    okfft_vd re1 = okfft_vd_load(lut + 8);
+    okfft_vd im1 = okfft_vd_load(lut + 12);
+    okfft_vd re2 = okfft_vd_load(lut + 16);
+    okfft_vd im2 = okfft_vd_load(lut + 20);
+
+    OKFFT_VD_KN(re0, im0, r01, r23, r45, r67);
+    OKFFT_VD_KNKN(re1, im1, re2, im2, r01, r45, r89, r1213, r23, r67, r1011, r1415);
+
+    okfft_vd_store4(out + 0, r01, r23, r45, r67);
+    okfft_vd_store4(out + 16, r89, r1011, r1213, r1415);
+}